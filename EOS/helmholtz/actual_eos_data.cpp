@@ -2,6 +2,7 @@
 
 AMREX_GPU_MANAGED bool helmholtz::do_coulomb;
 AMREX_GPU_MANAGED bool helmholtz::input_is_constant;
+AMREX_GPU_MANAGED bool helmholtz::use_interleaved_table;
 
 AMREX_GPU_MANAGED int helmholtz::itmax;
 AMREX_GPU_MANAGED int helmholtz::jtmax;
@@ -23,16 +24,20 @@ AMREX_GPU_MANAGED amrex::Real helmholtz::ttol;
 AMREX_GPU_MANAGED amrex::Real helmholtz::dtol;
 
 // for the helmholtz free energy tables
-AMREX_GPU_MANAGED amrex::Real helmholtz::f[jmax][imax][9];
+AMREX_GPU_MANAGED const amrex::Real (*helmholtz::f)[imax][9] = nullptr;
 
 // for the pressure derivative with density tables
-AMREX_GPU_MANAGED amrex::Real helmholtz::dpdf[jmax][imax][4];
+AMREX_GPU_MANAGED const amrex::Real (*helmholtz::dpdf)[imax][4] = nullptr;
 
 // for chemical potential tables
-AMREX_GPU_MANAGED amrex::Real helmholtz::ef[jmax][imax][4];
+AMREX_GPU_MANAGED const amrex::Real (*helmholtz::ef)[imax][4] = nullptr;
 
 // for the number density tables
-AMREX_GPU_MANAGED amrex::Real helmholtz::xf[jmax][imax][4];
+AMREX_GPU_MANAGED const amrex::Real (*helmholtz::xf)[imax][4] = nullptr;
+
+void* helmholtz::table_alloc = nullptr;
+void* helmholtz::table_map = nullptr;
+std::size_t helmholtz::table_map_bytes = 0;
 
 // for storing the differences
 AMREX_GPU_MANAGED amrex::Real helmholtz::dt_sav[jmax];
@@ -44,3 +49,21 @@ AMREX_GPU_MANAGED amrex::Real helmholtz::dd_sav[imax];
 AMREX_GPU_MANAGED amrex::Real helmholtz::dd2_sav[imax];
 AMREX_GPU_MANAGED amrex::Real helmholtz::ddi_sav[imax];
 AMREX_GPU_MANAGED amrex::Real helmholtz::dd2i_sav[imax];
+
+// interleaved per-cell table
+AMREX_GPU_MANAGED helmholtz::helm_cell_t* helmholtz::cell_table = nullptr;
+void* helmholtz::cell_table_alloc = nullptr;
+
+// inverse (rho, e) -> T table
+AMREX_GPU_MANAGED bool helmholtz::use_inverse_table;
+AMREX_GPU_MANAGED bool helmholtz::inverse_table_polish;
+AMREX_GPU_MANAGED amrex::Real helmholtz::inverse_table_tol;
+
+AMREX_GPU_MANAGED int helmholtz::inv_nrho;
+AMREX_GPU_MANAGED int helmholtz::inv_nabar;
+AMREX_GPU_MANAGED int helmholtz::inv_nye;
+AMREX_GPU_MANAGED int helmholtz::inv_ne;
+
+AMREX_GPU_MANAGED amrex::Real* helmholtz::inv_loge_lo = nullptr;
+AMREX_GPU_MANAGED amrex::Real* helmholtz::inv_loge_hi = nullptr;
+AMREX_GPU_MANAGED amrex::Real* helmholtz::inv_logT = nullptr;
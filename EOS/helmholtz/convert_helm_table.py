@@ -1,5 +1,22 @@
 # Read in the Helmholtz EOS table and create a
-# Fortran module containing the data.
+# Fortran module containing the data, or with --binary,
+# helm_table.bin: the table in the layout the EOS holds it in
+# memory, which it reads (or on CPUs, maps, sharing it between the
+# ranks on a node) in place of helm_table.dat.  The binary file has
+# the header described in util/table_io.F90 (magic "MICROHLM", dims
+# imax, jmax, 21), and then the reals
+# f(9,imax,jmax), dpdf(4,imax,jmax), ef(4,imax,jmax), xf(4,imax,jmax)
+# in Fortran order -- the same as f[jmax][imax][9], etc. in C++ --
+# with the derivatives in each in the order the interpolation uses.
+
+import argparse
+import struct
+import zlib
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--binary", action="store_true",
+                    help="write helm_table.bin instead of the Fortran module")
+args = parser.parse_args()
 
 # Number of density rows
 imax = 541
@@ -92,6 +109,32 @@ for j in range(jmax):
 table.close()
 
 
+if args.binary:
+
+    # the columns of each table in the order the EOS holds them (as
+    # in actual_eos_init): for f, those of helm_table.dat in the order
+    # 0, 2, 4, 1, 3, 5, 6, 7, 8, and for the others 0, 2, 1, 3
+    tables = [(f, ft, fdt, fd, fdd, ftt, fddt, fdtt, fddtt),
+              (dpdf, dpdft, dpdfd, dpdfdt),
+              (ef, eft, efd, efdt),
+              (xf, xft, xfd, xfdt)]
+
+    values = []
+    for columns in tables:
+        for j in range(jmax):
+            for i in range(imax):
+                values += [float(c[i][j].replace('D', 'E').replace('d', 'e')) for c in columns]
+
+    data = struct.pack("<{}d".format(len(values)), *values)
+
+    with open('helm_table.bin', 'wb') as out:
+        out.write(struct.pack("<8s8iq", b"MICROHLM", 1, imax, jmax, 9 + 4 + 4 + 4,
+                              0, 0, 0, 0, zlib.adler32(data)))
+        out.write(data)
+
+    raise SystemExit
+
+
 # Now write out the module
 
 module_file = 'helm_table.F90'
@@ -0,0 +1,96 @@
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_Vector.H>
+
+#include <eos_telemetry.H>
+
+#include <string>
+
+// Declare extern variables
+
+AMREX_GPU_MANAGED unsigned long long EOSTelemetry::calls[EOSTelemetry::num_inputs];
+AMREX_GPU_MANAGED unsigned long long EOSTelemetry::solves[EOSTelemetry::num_inputs];
+AMREX_GPU_MANAGED unsigned long long EOSTelemetry::iterations[EOSTelemetry::num_inputs];
+AMREX_GPU_MANAGED unsigned long long EOSTelemetry::iter_hist[EOSTelemetry::num_inputs][EOSTelemetry::num_iter_bins];
+AMREX_GPU_MANAGED unsigned long long EOSTelemetry::unconverged[EOSTelemetry::num_inputs];
+AMREX_GPU_MANAGED unsigned long long EOSTelemetry::clamps[EOSTelemetry::num_inputs];
+AMREX_GPU_MANAGED unsigned long long EOSTelemetry::resets[EOSTelemetry::num_inputs];
+AMREX_GPU_MANAGED unsigned long long EOSTelemetry::overrides;
+
+void eos_telemetry_clear ()
+{
+  using namespace EOSTelemetry;
+
+  for (int n = 0; n < num_inputs; n++) {
+    calls[n] = 0;
+    solves[n] = 0;
+    iterations[n] = 0;
+    unconverged[n] = 0;
+    clamps[n] = 0;
+    resets[n] = 0;
+    for (int b = 0; b < num_iter_bins; b++) {
+      iter_hist[n][b] = 0;
+    }
+  }
+
+  overrides = 0;
+}
+
+void eos_telemetry_report ()
+{
+#ifdef EOS_TELEMETRY
+  using namespace EOSTelemetry;
+
+  const std::string input_names[num_inputs] = {"rt", "rh", "tp", "rp", "re", "ps", "ph", "th"};
+  const std::string bin_names[num_iter_bins] = {"0", "1", "2", "3", "4", "5-8", "9-16", "17-32", "33-64", "65+"};
+
+  // pack everything into one buffer so we only need one reduction
+
+  const int nper = 6 + num_iter_bins;
+  amrex::Vector<long> buf(nper * num_inputs + 1);
+
+  for (int n = 0; n < num_inputs; n++) {
+    long* b = &buf[nper * n];
+    b[0] = calls[n];
+    b[1] = solves[n];
+    b[2] = iterations[n];
+    b[3] = unconverged[n];
+    b[4] = clamps[n];
+    b[5] = resets[n];
+    for (int i = 0; i < num_iter_bins; i++) {
+      b[6 + i] = iter_hist[n][i];
+    }
+  }
+  buf[nper * num_inputs] = overrides;
+
+  amrex::ParallelDescriptor::ReduceLongSum(buf.dataPtr(), buf.size(),
+                                           amrex::ParallelDescriptor::IOProcessorNumber());
+
+  amrex::Print() << std::endl << "EOS telemetry:" << std::endl;
+
+  for (int n = 0; n < num_inputs; n++) {
+    const long* b = &buf[nper * n];
+
+    if (b[0] == 0 && b[1] == 0) continue;
+
+    amrex::Print() << "  eos_input_" << input_names[n]
+                   << ": calls = " << b[0]
+                   << ", solves = " << b[1]
+                   << ", mean iterations = "
+                   << (b[1] > 0 ? static_cast<double>(b[2]) / b[1] : 0.0)
+                   << ", unconverged = " << b[3]
+                   << ", clamped = " << b[4]
+                   << ", reset = " << b[5] << std::endl;
+
+    if (b[1] > 0) {
+      amrex::Print() << "    iterations:";
+      for (int i = 0; i < num_iter_bins; i++) {
+        amrex::Print() << " [" << bin_names[i] << "] " << b[6 + i];
+      }
+      amrex::Print() << std::endl;
+    }
+  }
+
+  amrex::Print() << "  eos_override modified the state " << buf[nper * num_inputs] << " times" << std::endl;
+#endif
+}
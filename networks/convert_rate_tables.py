@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+
+"""Convert the ASCII data files of the pynucastro networks -- the
+tabulated weak rates (e.g. 23Na-23Ne_electroncapture.dat) and the
+reaclib rate metadata (reaclib_rate_metadata.dat) -- to the binary
+form read by util/table_io.F90.  Each file.dat is written as file.bin
+alongside it (or in --odir), and the networks read the .bin in place
+of the .dat whenever it is present.
+
+A binary table is a 48 byte header,
+
+   magic     8 characters, "MICROTAB" for a rate table or
+             "MICRORLB" for the reaclib metadata
+   version   int32
+   dims(3)   int32: num_temp, num_rhoy, num_vars for a rate table;
+             number_reaclib_sets, nrat_reaclib, 0 for the metadata
+   reserved  4 int32, 0
+   checksum  int64, the Adler-32 checksum of the data
+
+followed by the data, little-endian, arrays in Fortran order.  For a
+rate table the data are temp(num_temp), rhoy(num_rhoy), and
+rate(num_temp, num_rhoy, num_vars), all 8 byte reals; for the metadata
+ctemp_rate(7, number_reaclib_sets) as 8 byte reals, then
+rate_start_idx(nrat_reaclib) and rate_extra_mult(nrat_reaclib) as 4
+byte integers.
+
+"""
+
+import os
+import sys
+import struct
+import zlib
+import argparse
+
+TABLE_IO_VERSION = 1
+
+RATE_TABLE_MAGIC = b"MICROTAB"
+REACLIB_MAGIC = b"MICRORLB"
+
+
+def write_binary(bin_file, magic, dims, data):
+    """write the header and data to bin_file"""
+
+    header = struct.pack("<8s8iq", magic, TABLE_IO_VERSION,
+                         *dims, 0, 0, 0, 0, zlib.adler32(data))
+
+    with open(bin_file, "wb") as f:
+        f.write(header)
+        f.write(data)
+
+
+def convert_rate_table(dat_file, bin_file):
+    """convert a tabulated weak rate: after the comment lines (starting
+    with !), blocks of constant rhoy, one line per temperature, of
+    rhoy, T, and the table variables, separated by blank lines"""
+
+    rows = []
+    with open(dat_file) as f:
+        for line in f:
+            if not line.strip() or line.lstrip().startswith("!"):
+                continue
+            rows.append([float(v) for v in line.split()])
+
+    num_vars = len(rows[0]) - 2
+
+    rhoy = []
+    for r in rows:
+        if not rhoy or r[0] != rhoy[-1]:
+            rhoy.append(r[0])
+
+    num_rhoy = len(rhoy)
+    num_temp = len(rows) // num_rhoy
+
+    if num_temp * num_rhoy != len(rows) or any(len(r) != num_vars + 2 for r in rows):
+        sys.exit(f"{dat_file}: not a table of {num_rhoy} rhoy blocks")
+
+    temp = [rows[i][1] for i in range(num_temp)]
+
+    # the lines run over temperature fastest, then rhoy, as does the
+    # table in Fortran order
+    data = struct.pack(f"<{num_temp}d", *temp)
+    data += struct.pack(f"<{num_rhoy}d", *rhoy)
+    for k in range(num_vars):
+        data += struct.pack(f"<{len(rows)}d", *[r[k+2] for r in rows])
+
+    write_binary(bin_file, RATE_TABLE_MAGIC,
+                 (num_temp, num_rhoy, num_vars), data)
+
+    print(f"{dat_file} -> {bin_file}: num_temp = {num_temp}, num_rhoy = {num_rhoy}, num_vars = {num_vars}")
+
+
+def convert_reaclib_metadata(dat_file, bin_file):
+    """convert the reaclib metadata: the 7 coefficients of each reaclib
+    set (as reals), then the start index and the extra multiplicity of
+    each rate (as integers), one number per line"""
+
+    reals = []
+    ints = []
+    with open(dat_file) as f:
+        for line in f:
+            v = line.strip()
+            if not v:
+                continue
+            if any(c in v for c in ".eEdD"):
+                if ints:
+                    sys.exit(f"{dat_file}: reaclib coefficient after the rate indices")
+                reals.append(float(v.replace("d", "e").replace("D", "e")))
+            else:
+                ints.append(int(v))
+
+    if len(reals) % 7 != 0 or len(ints) % 2 != 0:
+        sys.exit(f"{dat_file}: not reaclib rate metadata")
+
+    number_reaclib_sets = len(reals) // 7
+    nrat_reaclib = len(ints) // 2
+
+    data = struct.pack(f"<{len(reals)}d", *reals)
+    data += struct.pack(f"<{len(ints)}i", *ints)
+
+    write_binary(bin_file, REACLIB_MAGIC,
+                 (number_reaclib_sets, nrat_reaclib, 0), data)
+
+    print(f"{dat_file} -> {bin_file}: number_reaclib_sets = {number_reaclib_sets}, nrat_reaclib = {nrat_reaclib}")
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("files", nargs="+",
+                        help="ASCII rate tables or reaclib_rate_metadata.dat files, or network directories")
+    parser.add_argument("--odir", default=None,
+                        help="directory to write the binary files to (default: alongside the inputs)")
+
+    args = parser.parse_args()
+
+    dat_files = []
+    for name in args.files:
+        if os.path.isdir(name):
+            dat_files += sorted(os.path.join(name, f) for f in os.listdir(name)
+                                if f.endswith(".dat"))
+        else:
+            dat_files.append(name)
+
+    for dat_file in dat_files:
+        base = os.path.basename(dat_file)
+        odir = args.odir if args.odir else os.path.dirname(dat_file)
+        bin_file = os.path.join(odir, os.path.splitext(base)[0] + ".bin")
+
+        if base == "reaclib_rate_metadata.dat":
+            convert_reaclib_metadata(dat_file, bin_file)
+        else:
+            convert_rate_table(dat_file, bin_file)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+
+"""Write a table of nuclear statistical equilibrium (NSE) abundances
+for a network, in the format read by nse_table.F90.
+
+For each (log10 rho, log10 T, Ye) on a uniform grid, the abundances
+of the network's species are found from the Saha equation,
+
+   X_i = (A_i m_u / rho) G_i (A_i m_u k T / (2 pi hbar^2))^(3/2)
+         exp((Z_i mu_p + N_i mu_n + B_i) / k T)
+
+with the proton and neutron chemical potentials set by sum X_i = 1
+and sum (Z_i / A_i) X_i = Ye.  The binding energies B_i are read from
+the network's actual_network.F90 (the bion(...) = ... lines), and the
+partition functions G_i are the ground state spin degeneracies.  There
+are no Coulomb corrections.
+
+Only the strong equilibrium is computed here: the dYe/dt and neutrino
+loss columns of the table are written as zero, so that Ye is constant
+in NSE.  Tables that include the weak rates (e.g. computed with a
+large network) can be used in the same format.
+
+If a nucleus appears twice in the network (e.g. H1 and p in aprox19),
+all of its abundance is given to the last one listed.
+
+"""
+
+import os
+import re
+import sys
+import math
+import argparse
+
+from general_null import write_network
+
+# cgs, the same values as constants/constants_cgs.f90
+k_B = 1.3806488e-16
+hbar = 1.054571726e-27
+n_A = 6.02214129e23
+MeV2erg = 1.602176487e-12 * 1.0e6
+m_u = 1.0 / n_A
+
+# ground state spins, keyed on (Z, A); even-even nuclei have J = 0
+spins = {(0, 1): 0.5, (1, 1): 0.5, (2, 3): 0.5, (7, 14): 1.0}
+
+
+def get_binding_energies(network_file, species):
+    """return the binding energies (MeV) of the species, from the
+    bion(ixx) = value lines in actual_network.F90"""
+
+    indices = {}
+    bion = {}
+
+    with open(network_file) as f:
+        for line in f:
+            code = line.split("!")[0]
+
+            m = re.match(r"\s*integer\s*,\s*parameter\s*::\s*(\w+)\s*=\s*(\d+)\s*$", code, re.IGNORECASE)
+            if m:
+                name = m.group(1).lower()
+                if name not in indices:
+                    indices[name] = int(m.group(2))
+
+            m = re.match(r"\s*bion\(\s*(\w+)\s*\)\s*=\s*([0-9.eEdD+-]+?)(?:_rt)?\s*$", code, re.IGNORECASE)
+            if m:
+                value = float(m.group(2).lower().replace("d", "e"))
+                bion[indices[m.group(1).lower()]] = value
+
+    if len(bion) != len(species):
+        sys.exit("make_nse_table.py: ERROR: unable to find the binding energies of all the species")
+
+    return [bion[n+1] for n in range(len(species))]
+
+
+def make_uniform(vmin, vmax, n):
+    if n == 1:
+        return [vmin]
+    return [vmin + (vmax - vmin) * i / (n - 1) for i in range(n)]
+
+
+class NSESolver:
+    """the Saha equation for a set of nuclei"""
+
+    def __init__(self, A, Z, B):
+        self.A = A
+        self.Z = Z
+        self.N = [a - z for a, z in zip(A, Z)]
+        self.B = B
+        self.G = []
+        for a, z in zip(A, Z):
+            key = (int(round(z)), int(round(a)))
+            if key in spins:
+                self.G.append(2.0 * spins[key] + 1.0)
+            else:
+                if key[0] % 2 == 1 or (key[1] - key[0]) % 2 == 1:
+                    print("make_nse_table.py: WARNING: no spin for (Z, A) = {}, using J = 0".format(key))
+                self.G.append(1.0)
+
+        # the starting guess for the chemical potentials, mu / kT
+        self.guess = None
+
+    def log_x(self, rho, T, eta_p, eta_n):
+        kT = k_B * T
+        logs = []
+        for a, z, n, b, g in zip(self.A, self.Z, self.N, self.B, self.G):
+            logs.append(math.log(a * m_u / rho * g) +
+                        1.5 * math.log(a * m_u * kT / (2.0 * math.pi * hbar**2)) +
+                        b * MeV2erg / kT + z * eta_p + n * eta_n)
+        return logs
+
+    def solve_eta(self, l0, delta, eta):
+        """for eta_p - eta_n = delta, return the eta = (eta_p + eta_n) / 2
+        that gives sum X_i = 1 and the mass fractions.  log sum X_i is
+        convex and increasing in eta, so Newton's method converges from
+        any starting point"""
+
+        for _ in range(100):
+            logs = [l + a * eta + 0.5 * (z - n) * delta
+                    for l, a, z, n in zip(l0, self.A, self.Z, self.N)]
+            lmax = max(logs)
+            x = [math.exp(l - lmax) for l in logs]
+            s = sum(x)
+
+            g = lmax + math.log(s)
+            dg = sum(xi * a for xi, a in zip(x, self.A)) / s
+
+            eta -= g / dg
+            if abs(g) < 1.e-12 or abs(g / dg) < 1.e-15 * abs(eta):
+                break
+        else:
+            sys.exit("make_nse_table.py: ERROR: NSE normalization did not converge")
+
+        return eta, [math.exp(l - g) for l in logs]
+
+    def solve(self, rho, T, ye):
+        """return the mass fractions in NSE.  With eta_p - eta_n = delta
+        and sum X_i = 1, Ye is a nondecreasing function of delta, so we
+        find delta by bracketing and the Illinois method"""
+
+        l0 = self.log_x(rho, T, 0.0, 0.0)
+
+        if self.guess is None:
+            delta, eta = 0.0, 0.0
+        else:
+            delta, eta = self.guess
+
+        def f(delta):
+            nonlocal eta
+            eta, x = self.solve_eta(l0, delta, eta)
+            return sum(xi * z / a for xi, z, a in zip(x, self.Z, self.A)) - ye, x
+
+        # bracket the root
+        lo, hi = delta - 0.1, delta + 0.1
+        f_lo, _ = f(lo)
+        f_hi, _ = f(hi)
+
+        while f_lo > 0.0:
+            lo, hi, f_hi = lo - 2.0 * (hi - lo), lo, f_lo
+            f_lo, _ = f(lo)
+            if lo < -1.e4:
+                sys.exit("make_nse_table.py: ERROR: Ye = {} is out of reach of the network".format(ye))
+
+        while f_hi < 0.0:
+            lo, hi, f_lo = hi, hi + 2.0 * (hi - lo), f_hi
+            f_hi, _ = f(hi)
+            if hi > 1.e4:
+                sys.exit("make_nse_table.py: ERROR: Ye = {} is out of reach of the network".format(ye))
+
+        side = 0
+
+        for _ in range(200):
+            if f_hi == f_lo:
+                delta = 0.5 * (lo + hi)
+            else:
+                delta = (lo * f_hi - hi * f_lo) / (f_hi - f_lo)
+            fd, x = f(delta)
+
+            if abs(fd) < 1.e-12 * ye or hi - lo < 1.e-14 * max(1.0, abs(delta)):
+                break
+
+            if fd < 0.0:
+                lo, f_lo = delta, fd
+                if side == -1:
+                    f_hi *= 0.5
+                side = -1
+            else:
+                hi, f_hi = delta, fd
+                if side == 1:
+                    f_lo *= 0.5
+                side = 1
+        else:
+            sys.exit("make_nse_table.py: ERROR: NSE solve did not converge at rho = {}, T = {}, Ye = {}".format(rho, T, ye))
+
+        self.guess = (delta, eta)
+
+        return x
+
+
+def main():
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--microphysics_path", type=str, default="",
+                        help="path to Microphysics/")
+    parser.add_argument("--net", type=str, default="",
+                        help="name of the network")
+    parser.add_argument("-o", "--output", type=str, default="nse_table.dat",
+                        help="name of the table to write")
+    parser.add_argument("--logrho", type=float, nargs=3, default=[7.0, 10.0, 31],
+                        metavar=("MIN", "MAX", "N"), help="log10 density range and number of points")
+    parser.add_argument("--logT", type=float, nargs=3, default=[9.5, 10.0, 26],
+                        metavar=("MIN", "MAX", "N"), help="log10 temperature range and number of points")
+    parser.add_argument("--ye", type=float, nargs=3, default=[0.46, 0.5, 21],
+                        metavar=("MIN", "MAX", "N"), help="Ye range and number of points")
+
+    args = parser.parse_args()
+
+    net_dir = os.path.join(args.microphysics_path, "networks", args.net)
+
+    species = []
+    aux_vars = []
+    err = write_network.parse_net_file(species, aux_vars,
+                                       os.path.join(net_dir, "{}.net".format(args.net)))
+    if err:
+        sys.exit("make_nse_table.py: ERROR: unable to parse the network file")
+
+    bion = get_binding_energies(os.path.join(net_dir, "actual_network.F90"), species)
+
+    # the nuclei that take part in the equilibrium, dropping all but
+    # the last of any duplicates
+    nuclei = []
+    for n, s in enumerate(species):
+        if any((t.A, t.Z) == (s.A, s.Z) for t in species[n+1:]):
+            print("make_nse_table.py: {} is a duplicate, giving its abundance to the last".format(s.short_name))
+            continue
+        nuclei.append(n)
+
+    solver = NSESolver([species[n].A for n in nuclei],
+                       [species[n].Z for n in nuclei],
+                       [bion[n] for n in nuclei])
+
+    nrho = int(args.logrho[2])
+    nt = int(args.logT[2])
+    nye = int(args.ye[2])
+
+    logrho = make_uniform(args.logrho[0], args.logrho[1], nrho)
+    logT = make_uniform(args.logT[0], args.logT[1], nt)
+    ye = make_uniform(args.ye[0], args.ye[1], nye)
+
+    print("make_nse_table.py: writing {}".format(args.output))
+
+    with open(args.output, "w") as f:
+        f.write("# NSE table for the {} network, written by make_nse_table.py\n".format(args.net))
+        f.write("# (strong equilibrium only: dYe/dt and the neutrino losses are zero)\n")
+        f.write("# number of species, log10 rho points, log10 T points, Ye points\n")
+        f.write("{} {} {} {}\n".format(len(species), nrho, nt, nye))
+        f.write("# species: short name, A, Z, binding energy (MeV)\n")
+        for s, b in zip(species, bion):
+            f.write("{} {} {} {}\n".format(s.short_name, s.A, s.Z, b))
+        f.write("# log10 rho, log10 T, and Ye ranges\n")
+        f.write("{} {}\n".format(logrho[0], logrho[-1]))
+        f.write("{} {}\n".format(logT[0], logT[-1]))
+        f.write("{} {}\n".format(ye[0], ye[-1]))
+        f.write("# X(1:nspec), dYe/dt (1/s), neutrino losses (erg/g/s); Ye varies fastest, then T, then rho\n")
+
+        for r in logrho:
+            for t in logT:
+                # continue along Ye from the first point of the last row
+                start = solver.guess
+                for i, y in enumerate(ye):
+                    x_nuc = solver.solve(10.0**r, 10.0**t, y)
+                    if i == 0:
+                        start = solver.guess
+                    x = [0.0] * len(species)
+                    for n, xn in zip(nuclei, x_nuc):
+                        x[n] = xn
+                    f.write(" ".join("{:.10e}".format(v) for v in x + [0.0, 0.0]) + "\n")
+                solver.guess = start
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,328 @@
+#!/usr/bin/env python3
+
+"""Write a fully unrolled LU factorization and solve for the
+integrators' linear systems, I - gamma J, specialized to the Jacobian
+structure of a network.
+
+The species part of the structure is read from the network's
+actual_rhs.F90 -- every jac(i, j) = ..., dfdy(i, j) = ..., or
+set_jac_entry(jac, i, j, ...) where i and j are species indices from
+actual_network.F90.  The temperature column and the temperature and
+energy rows are taken to be dense, the energy column is zero (nothing
+depends on the energy), and the diagonal is always present.
+
+The elimination order is minimum degree on that structure, with the
+pivots taken from the diagonal, and only the operations that touch
+structural nonzeros (including fill) are written out, so the result is
+straight-line code with no loops or structural tests.
+
+"""
+
+import os
+import re
+import sys
+import argparse
+
+from general_null import write_network
+
+
+def get_species_indices(network_file, nspec):
+    """return a dictionary mapping the species index names defined in
+    actual_network.F90 (e.g. ihe4) to their (1-based) values"""
+
+    indices = {}
+
+    with open(network_file) as f:
+        for line in f:
+            m = re.match(r"\s*integer\s*,\s*parameter\s*::\s*(\w+)\s*=\s*(\d+)\s*$", line, re.IGNORECASE)
+            if m:
+                name = m.group(1).lower()
+                value = int(m.group(2))
+                if name.startswith("i") and 1 <= value <= nspec and name not in indices:
+                    indices[name] = value
+
+    return indices
+
+
+def get_species_pattern(rhs_file, indices):
+    """return the set of (row, col) species Jacobian entries that the
+    network sets in actual_rhs.F90.  Every assignment to the Jacobian
+    must be accounted for -- an entry we cannot resolve to species
+    indices would be silently left out of the factorization -- so we
+    stop on anything other than:
+
+    * entries with species indices on both sides
+    * entries in the temperature or energy row or column, which are
+      taken to be dense anyway
+    * zeroing (e.g. jac(:,:) = ZERO), which adds no structure
+    * a copy of the whole species block from a local array (e.g.
+      jac(1:nspec,1:nspec) = spec_jac), provided the network fills it
+      through dfdy(i, j) = ... entries that we do resolve
+    """
+
+    # the generic T and e rows and columns are handled separately
+    generic = ["net_itemp", "net_ienuc"]
+
+    # ways to write the whole species range
+    full_range = [":", "1:nspec"]
+
+    zero = re.compile(r"^(?:zero|0|0\.0*|0\.0*(?:_rt|d0|e0))$", re.IGNORECASE)
+    name = re.compile(r"^\w+$")
+
+    patterns = [re.compile(r"\b(jac|dfdy)\(\s*([^,()]+?)\s*,\s*([^,()]+?)\s*\)\s*=(?!=)(.*)", re.IGNORECASE),
+                re.compile(r"\b(set_jac_entry)\(\s*\w+\s*,\s*([^,()]+?)\s*,\s*([^,()]+?)\s*,(.*)", re.IGNORECASE)]
+
+    entries = set()
+    dfdy_entries = set()
+    block_copies = []
+
+    with open(rhs_file) as f:
+        for lineno, line in enumerate(f, 1):
+            code = line.split("!")[0]
+            for p in patterns:
+                for m in p.finditer(code):
+                    array = m.group(1).lower()
+                    row = m.group(2).lower()
+                    col = m.group(3).lower()
+                    value = m.group(4).strip().rstrip(")").strip()
+
+                    where = "({}, {}) at {}:{}".format(row, col, rhs_file, lineno)
+
+                    if row in indices and col in indices:
+                        entries.add((indices[row], indices[col]))
+                        if array == "dfdy":
+                            dfdy_entries.add((indices[row], indices[col]))
+
+                    elif row in generic or col in generic:
+                        continue
+
+                    elif zero.match(value):
+                        continue
+
+                    elif row in full_range and col in full_range and name.match(value):
+                        block_copies.append(where)
+
+                    else:
+                        sys.exit("write_unrolled_lu.py: ERROR: cannot determine the Jacobian entry " +
+                                 where + " -- set it with species indices or build with USE_UNROLLED_LU=FALSE")
+
+    if block_copies and not dfdy_entries:
+        sys.exit("write_unrolled_lu.py: ERROR: cannot determine the entries of the Jacobian block copied at " +
+                 block_copies[0] + " -- no dfdy(i, j) entries fill it")
+
+    return entries
+
+
+def get_pattern(nspec, species_entries):
+    """return the structure of I - gamma J as a list of sets: pattern[i]
+    holds the nonzero columns of row i (0-based)"""
+
+    neqs = nspec + 2
+    itemp = nspec
+    ienuc = nspec + 1
+
+    pattern = [set() for _ in range(neqs)]
+
+    for i in range(neqs):
+        pattern[i].add(i)
+
+    for (i, j) in species_entries:
+        pattern[i-1].add(j-1)
+
+    # every species depends on temperature, and the temperature and
+    # energy rows depend on all the species and temperature
+    for i in range(nspec):
+        pattern[i].add(itemp)
+
+    for i in [itemp, ienuc]:
+        for j in range(nspec+1):
+            pattern[i].add(j)
+
+    return pattern
+
+
+def minimum_degree_order(pattern):
+    """minimum degree ordering of the symmetrized pattern, taking the
+    lowest index on ties"""
+
+    neqs = len(pattern)
+
+    graph = [set() for _ in range(neqs)]
+    for i in range(neqs):
+        for j in pattern[i]:
+            if i != j:
+                graph[i].add(j)
+                graph[j].add(i)
+
+    order = []
+    remaining = set(range(neqs))
+
+    while remaining:
+        k = min(remaining, key=lambda n: (len(graph[n] & remaining), n))
+        order.append(k)
+        remaining.remove(k)
+
+        nbrs = graph[k] & remaining
+        for i in nbrs:
+            graph[i] |= nbrs - {i}
+
+    return order
+
+
+def symbolic_factor(pattern, order):
+    """add the fill from eliminating in the given order to pattern"""
+
+    pos = {k: p for p, k in enumerate(order)}
+
+    for p, k in enumerate(order):
+        later = [i for i in order[p+1:]]
+        for i in later:
+            if k in pattern[i]:
+                for j in pattern[k]:
+                    if pos[j] > p:
+                        pattern[i].add(j)
+
+    return pattern
+
+
+def write_unrolled_lu(net, nspec, species_entries, out_file):
+    """write the Fortran module with the factorization and solve"""
+
+    neqs = nspec + 2
+
+    pattern = get_pattern(nspec, species_entries)
+    nnz_jac = sum(len(r) for r in pattern)
+
+    order = minimum_degree_order(pattern)
+    pattern = symbolic_factor(pattern, order)
+    nnz_lu = sum(len(r) for r in pattern)
+
+    pos = {k: p for p, k in enumerate(order)}
+
+    def a(i, j):
+        return "a({},{})".format(i+1, j+1)
+
+    def b(i):
+        return "b({})".format(i+1)
+
+    factor = []
+    forward = []
+    backward = []
+
+    nops = 0
+
+    for p, k in enumerate(order):
+        lower = [i for i in order[p+1:] if k in pattern[i]]
+        upper = [j for j in order[p+1:] if j in pattern[k]]
+
+        factor.append("")
+        factor.append("! pivot {}".format(k+1))
+        factor.append("if ({} == ZERO) then".format(a(k, k)))
+        factor.append("   info = {}".format(k+1))
+        factor.append("   return")
+        factor.append("endif")
+        factor.append("{} = ONE / {}".format(a(k, k), a(k, k)))
+
+        for i in lower:
+            factor.append("{} = {} * {}".format(a(i, k), a(i, k), a(k, k)))
+            for j in upper:
+                factor.append("{} = {} - {} * {}".format(a(i, j), a(i, j), a(i, k), a(k, j)))
+                nops += 1
+
+        for i in lower:
+            forward.append("{} = {} - {} * {}".format(b(i), b(i), a(i, k), b(k)))
+
+    for p, k in reversed(list(enumerate(order))):
+        upper = [j for j in order[p+1:] if j in pattern[k]]
+        for j in upper:
+            backward.append("{} = {} - {} * {}".format(b(k), b(k), a(k, j), b(j)))
+        backward.append("{} = {} * {}".format(b(k), b(k), a(k, k)))
+
+    indent = 4 * " "
+
+    with open(out_file, "w") as f:
+
+        f.write("! This file was automatically generated by write_unrolled_lu.py\n")
+        f.write("! for the {} network -- do not edit.\n".format(net))
+        f.write("!\n")
+        f.write("! {} equations, {} nonzeros in I - gamma J, {} in the factors,\n".format(neqs, nnz_jac, nnz_lu))
+        f.write("! {} multiply-adds per factorization (dense: {}).\n".format(nops, sum((neqs-p-1)**2 for p in range(neqs))))
+        f.write("! Elimination order: {}\n".format(" ".join(str(k+1) for k in order)))
+        f.write("\n")
+        f.write("module unrolled_lu_module\n\n")
+        f.write("  use amrex_fort_module, only : rt => amrex_real\n")
+        f.write("  use burn_type_module, only : neqs\n\n")
+        f.write("  implicit none\n\n")
+        f.write("contains\n\n")
+
+        f.write("  subroutine unrolled_lu_factor(a, info)\n\n")
+        f.write("    ! Factor a in place, without pivoting.  On return the diagonal\n")
+        f.write("    ! holds the inverse pivots, and info is 0, or the row with a\n")
+        f.write("    ! zero pivot.\n\n")
+        f.write("    !$acc routine seq\n\n")
+        f.write("    use amrex_constants_module, only: ZERO, ONE\n\n")
+        f.write("    implicit none\n\n")
+        f.write("    real(rt), intent(inout) :: a(neqs, neqs)\n")
+        f.write("    integer, intent(out) :: info\n\n")
+        f.write("    !$gpu\n\n")
+        f.write("    info = 0\n")
+        for line in factor:
+            f.write("{}{}\n".format(indent if line else "", line))
+        f.write("\n  end subroutine unrolled_lu_factor\n\n\n\n")
+
+        f.write("  subroutine unrolled_lu_solve(a, b)\n\n")
+        f.write("    ! Solve a x = b with the factors from unrolled_lu_factor,\n")
+        f.write("    ! overwriting b with x.\n\n")
+        f.write("    !$acc routine seq\n\n")
+        f.write("    implicit none\n\n")
+        f.write("    real(rt), intent(in) :: a(neqs, neqs)\n")
+        f.write("    real(rt), intent(inout) :: b(neqs)\n\n")
+        f.write("    !$gpu\n\n")
+        f.write("    ! forward substitution\n")
+        for line in forward:
+            f.write("{}{}\n".format(indent, line))
+        f.write("\n    ! back substitution\n")
+        for line in backward:
+            f.write("{}{}\n".format(indent, line))
+        f.write("\n  end subroutine unrolled_lu_solve\n\n")
+        f.write("end module unrolled_lu_module\n")
+
+
+def main():
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--microphysics_path", type=str, default="",
+                        help="path to Microphysics/")
+    parser.add_argument("--net", type=str, default="",
+                        help="name of the network")
+    parser.add_argument("--odir", type=str, default="",
+                        help="output directory")
+
+    args = parser.parse_args()
+
+    net_dir = os.path.join(args.microphysics_path, "networks", args.net)
+
+    species = []
+    aux_vars = []
+    err = write_network.parse_net_file(species, aux_vars,
+                                       os.path.join(net_dir, "{}.net".format(args.net)))
+    if err:
+        sys.exit("write_unrolled_lu.py: ERROR: unable to parse the network file")
+
+    nspec = len(species)
+
+    indices = get_species_indices(os.path.join(net_dir, "actual_network.F90"), nspec)
+    species_entries = get_species_pattern(os.path.join(net_dir, "actual_rhs.F90"), indices)
+
+    try:
+        os.makedirs(args.odir)
+    except FileExistsError:
+        pass
+
+    out_file = os.path.join(args.odir, "unrolled_lu.F90")
+    print("write_unrolled_lu.py: writing {}".format(out_file))
+
+    write_unrolled_lu(args.net, nspec, species_entries, out_file)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,7 @@
+#include <aprox_rate_table.H>
+
+AMREX_GPU_MANAGED int RateTable::slot[AproxRates::NumRates];
+AMREX_GPU_MANAGED int RateTable::nslot = 0;
+AMREX_GPU_MANAGED int RateTable::power[AproxRates::NumRates][2];
+AMREX_GPU_MANAGED amrex::Real* RateTable::coef = nullptr;
+AMREX_GPU_MANAGED amrex::Real* RateTable::lk_coef = nullptr;
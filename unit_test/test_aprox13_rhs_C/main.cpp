@@ -0,0 +1,172 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Box.H>
+#include <AMReX_Loop.H>
+
+using namespace amrex;
+
+#include "test_aprox13_rhs.H"
+#include "test_aprox13_rhs_F.H"
+#include "AMReX_buildInfo.H"
+
+#include <network.H>
+#include <eos.H>
+#include <actual_rhs.H>
+
+#include <cmath>
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+
+    main_main();
+
+    amrex::Finalize();
+    return 0;
+}
+
+// relative difference, treating two zeros as agreeing
+Real rel_diff (const Real a, const Real b)
+{
+    if (a == b) return 0.0_rt;
+    return std::abs(a - b) / amrex::max(std::abs(a), std::abs(b));
+}
+
+void main_main ()
+{
+
+    int n_cell;
+
+    // inputs parameters
+    {
+        // ParmParse is way of reading inputs from the inputs file
+        ParmParse pp;
+
+        // n_cell is the number of points in density, temperature,
+        // and composition
+        pp.get("n_cell", n_cell);
+    }
+
+    // do the runtime parameter initializations and microphysics inits
+    if (ParallelDescriptor::IOProcessor()) {
+        std::cout << "reading extern runtime parameters ..." << std::endl;
+    }
+
+    ParmParse ppa("amr");
+
+    std::string probin_file = "probin";
+
+    ppa.query("probin_file", probin_file);
+
+    const int probin_file_length = probin_file.length();
+    Vector<int> probin_file_name(probin_file_length);
+
+    for (int i = 0; i < probin_file_length; i++)
+        probin_file_name[i] = probin_file[i];
+
+    init_unit_test(probin_file_name.dataPtr(), &probin_file_length);
+
+    init_extern_parameters();
+
+    eos_init();
+
+    aprox13_rhs_init();
+
+    Real dlogrho = 0.0e0_rt;
+    Real dlogT   = 0.0e0_rt;
+    Real dfrac   = 0.0e0_rt;
+
+    if (n_cell > 1) {
+        dlogrho = (std::log10(dens_max) - std::log10(dens_min))/(n_cell - 1);
+        dlogT   = (std::log10(temp_max) - std::log10(temp_min))/(n_cell - 1);
+        dfrac   = 1.0_rt / (n_cell - 1);
+    }
+
+    constexpr int neq = NumSpec + 1;
+
+    Real max_rhs_diff = 0.0_rt;
+    Real max_jac_diff = 0.0_rt;
+    int n_pattern_errors = 0;
+
+    Real time_cxx = 0.0_rt;
+    Real time_fortran = 0.0_rt;
+
+    Box bx(IntVect(AMREX_D_DECL(0, 0, 0)),
+           IntVect(AMREX_D_DECL(n_cell-1, n_cell-1, n_cell-1)));
+
+    amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+    {
+        // the composition goes from pure helium to an even mix of all
+        // of the species
+        Real frac = static_cast<Real>(k) * dfrac;
+
+        Real xn[NumSpec];
+        for (int n = 0; n < NumSpec; n++) {
+            xn[n] = frac / NumSpec;
+        }
+        xn[Aprox13::ihe4] += 1.0_rt - frac;
+
+        Real temp = std::pow(10.0_rt, std::log10(temp_min) + static_cast<Real>(j)*dlogT);
+        Real dens = std::pow(10.0_rt, std::log10(dens_min) + static_cast<Real>(i)*dlogrho);
+
+        Real ydot[neq];
+        aprox13_jac_t jac;
+
+        Real t0 = ParallelDescriptor::second();
+
+        aprox13_rhs(temp, dens, xn, ydot);
+        aprox13_jac(temp, dens, xn, jac);
+
+        Real t1 = ParallelDescriptor::second();
+
+        Real ydot_F[neq];
+        Real jac_F[neq * neq];
+
+        aprox13_rhs_jac_F(temp, dens, xn, ydot_F, jac_F);
+
+        Real t2 = ParallelDescriptor::second();
+
+        time_cxx += t1 - t0;
+        time_fortran += t2 - t1;
+
+        for (int n = 0; n < neq; n++) {
+            max_rhs_diff = amrex::max(max_rhs_diff, rel_diff(ydot[n], ydot_F[n]));
+        }
+
+        // jac_F is column-major
+
+        for (int jj = 0; jj < NumSpec; jj++) {
+            for (int ii = 0; ii < NumSpec; ii++) {
+                const Real f = jac_F[jj * neq + ii];
+                if (Aprox13::jac_slot(ii, jj) < 0) {
+                    if (f != 0.0_rt) {
+                        n_pattern_errors++;
+                    }
+                } else {
+                    max_jac_diff = amrex::max(max_jac_diff, rel_diff(jac.get(ii, jj), f));
+                }
+            }
+
+            max_jac_diff = amrex::max(max_jac_diff, rel_diff(jac.denucdy[jj], jac_F[jj * neq + NumSpec]));
+            max_jac_diff = amrex::max(max_jac_diff, rel_diff(jac.dfdT[jj], jac_F[NumSpec * neq + jj]));
+        }
+
+        max_jac_diff = amrex::max(max_jac_diff, rel_diff(jac.denucdT, jac_F[NumSpec * neq + NumSpec]));
+    });
+
+    amrex::Print() << "number of zones = " << bx.numPts() << std::endl;
+    amrex::Print() << "max relative difference in the RHS      = " << max_rhs_diff << std::endl;
+    amrex::Print() << "max relative difference in the Jacobian = " << max_jac_diff << std::endl;
+    amrex::Print() << "Fortran Jacobian entries outside the sparsity pattern = " << n_pattern_errors << std::endl;
+    amrex::Print() << "C++ time     = " << time_cxx << std::endl;
+    amrex::Print() << "Fortran time = " << time_fortran << std::endl;
+
+    if (n_pattern_errors > 0) {
+        amrex::Error("Fortran Jacobian has nonzeros outside the C++ sparsity pattern");
+    }
+
+    if (max_rhs_diff > rhs_tol || max_jac_diff > rhs_tol) {
+        amrex::Error("C++ and Fortran aprox13 RHS differ by more than rhs_tol");
+    }
+
+}
@@ -0,0 +1,89 @@
+subroutine init_unit_test(name, namlen) bind(C, name="init_unit_test")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use extern_probin_module
+  use microphysics_module
+
+  implicit none
+
+  integer, intent(in) :: namlen
+  integer, intent(in) :: name(namlen)
+
+  call runtime_init(name, namlen)
+
+  call microphysics_init(small_temp, small_dens)
+
+end subroutine init_unit_test
+
+
+
+! Evaluate the Fortran aprox13 right hand side and Jacobian for
+! comparison with the C++ version.  ydot holds dY/dt for each species
+! followed by the nuclear energy generation rate, and jac is the
+! (nspec+1) x (nspec+1) Jacobian of ydot with respect to (Y, T).  As
+! in the C++ version, the neutrino losses are not included.
+
+subroutine aprox13_rhs_jac_F(temp, dens, xn, ydot, jac) bind(C, name="aprox13_rhs_jac_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use network, only: nspec, aion_inv, zion
+  use burn_type_module, only: burn_t, njrows, njcols
+  use rate_type_module, only: rate_t
+  use actual_rhs_module, only: evaluate_rates, rhs, ener_gener_rate, dfdy_isotopes_aprox13
+  use jacobian_sparsity_module, only: set_jac_zero, get_jac_entry
+
+  implicit none
+
+  real(rt), intent(in), value :: temp, dens
+  real(rt), intent(in) :: xn(nspec)
+  real(rt), intent(inout) :: ydot(nspec+1)
+  real(rt), intent(inout) :: jac(nspec+1, nspec+1)
+
+  type (burn_t) :: state
+  type (rate_t) :: rr
+  real(rt) :: dfdy(njrows, njcols)
+  real(rt) :: y(nspec), yderivs(nspec)
+  logical :: deriva, for_jacobian_tderiv
+  integer :: i, j
+
+  state % rho = dens
+  state % T = temp
+  state % xn(:) = xn(:)
+  state % abar = 1.0_rt / sum(xn(:) * aion_inv(:))
+  state % zbar = state % abar * sum(xn(:) * zion(:) * aion_inv(:))
+
+  y(:) = xn(:) * aion_inv(:)
+
+  call evaluate_rates(state, rr)
+
+  ! right hand side
+
+  deriva = .false.
+  for_jacobian_tderiv = .false.
+  call rhs(y, rr, ydot(1:nspec), deriva, for_jacobian_tderiv)
+
+  call ener_gener_rate(ydot(1:nspec), ydot(nspec+1))
+
+  ! species Jacobian and the energy generation row, as in actual_jac
+
+  call set_jac_zero(dfdy)
+  call dfdy_isotopes_aprox13(y, state, rr, dfdy)
+
+  do j = 1, nspec
+     do i = 1, nspec
+        call get_jac_entry(dfdy, i, j, jac(i,j))
+     enddo
+     yderivs(:) = jac(1:nspec,j)
+     call ener_gener_rate(yderivs, jac(nspec+1,j))
+  enddo
+
+  ! temperature derivatives
+
+  deriva = .true.
+  for_jacobian_tderiv = .true.
+  call rhs(y, rr, yderivs, deriva, for_jacobian_tderiv)
+
+  jac(1:nspec,nspec+1) = yderivs(:)
+  call ener_gener_rate(yderivs, jac(nspec+1,nspec+1))
+
+end subroutine aprox13_rhs_jac_F
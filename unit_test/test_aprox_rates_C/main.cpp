@@ -17,9 +17,233 @@ using namespace amrex;
 #include <eos.H>
 #include <variables.H>
 #include <aprox_rates.H>
+#include <aprox_rates_batch.H>
+#include <aprox_rate_table.H>
 
 #include <cmath>
 
+// Evaluate the aprox21 rates over all zones with the batched rate
+// engine, both one zone at a time and in blocks, and compare them
+// with the per-zone values stored in state by the main test.
+void batch_benchmark(const MultiFab& state, const plot_t& vars, const int nrep)
+{
+    Vector<Real> temp, dens;
+    Vector<Real> ref;
+
+    const int num_rates = sizeof(AproxRates::aprox21_rates) / sizeof(int);
+
+    for ( MFIter mfi(state); mfi.isValid(); ++mfi )
+    {
+        const Box& bx = mfi.validbox();
+        auto const sp = state.const_array(mfi);
+
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+        {
+            temp.push_back(sp(i, j, k, vars.itemp));
+            dens.push_back(sp(i, j, k, vars.irho));
+            // the plotfile components are in AproxRates::rate_id order
+            for (int r = 0; r < AproxRates::NumRates; r++) {
+                for (int q = 0; q < 4; q++) {
+                    ref.push_back(sp(i, j, k, vars.ic12ag + 4*r + q));
+                }
+            }
+        });
+    }
+
+    const int npts = temp.size();
+
+    Vector<Real> rates(4 * AproxRates::NumRates * npts, 0.0);
+    Vector<Real> rates_zone(4 * AproxRates::NumRates, 0.0);
+
+    Real strt_time = ParallelDescriptor::second();
+
+    for (int r = 0; r < nrep; r++) {
+        for (int n = 0; n < npts; n++) {
+            aprox_rates_batch(1, &temp[n], &dens[n],
+                              AproxRates::aprox21_rates, num_rates, false,
+                              rates_zone.dataPtr());
+        }
+    }
+
+    Real zone_time = ParallelDescriptor::second() - strt_time;
+
+    strt_time = ParallelDescriptor::second();
+
+    for (int r = 0; r < nrep; r++) {
+        aprox_rates_batch(npts, temp.dataPtr(), dens.dataPtr(),
+                          AproxRates::aprox21_rates, num_rates, false,
+                          rates.dataPtr());
+    }
+
+    Real batch_time = ParallelDescriptor::second() - strt_time;
+
+    Real max_err = 0.0;
+    for (int m = 0; m < num_rates; m++) {
+        const int r = AproxRates::aprox21_rates[m];
+        for (int q = 0; q < 4; q++) {
+            for (int n = 0; n < npts; n++) {
+                Real a = rates[(4*r + q) * npts + n];
+                Real b = ref[(n * AproxRates::NumRates + r) * 4 + q];
+                if (b != 0.0) {
+                    max_err = amrex::max(max_err, std::abs(a - b) / std::abs(b));
+                } else {
+                    max_err = amrex::max(max_err, std::abs(a));
+                }
+            }
+        }
+    }
+
+    amrex::Print() << "aprox21 batched rate benchmark: " << npts << " zones x "
+                   << nrep << " repetitions, " << num_rates << " rates" << std::endl;
+    amrex::Print() << "  one zone at a time = " << zone_time << std::endl;
+    amrex::Print() << "  batched            = " << batch_time << std::endl;
+    amrex::Print() << "  speedup            = " << zone_time / batch_time << std::endl;
+    amrex::Print() << "  max rel. difference from the per-zone rates = " << max_err << std::endl;
+}
+
+// Build the rate table (rates/aprox_rate_table.H) for the aprox21
+// rates and langanke, and time looking the rates up in it against
+// evaluating them directly, one zone at a time, checking the tabulated
+// rates against the per-zone values stored in state by the main test.
+void table_benchmark(const MultiFab& state, const plot_t& vars, const int nrep)
+{
+    Vector<Real> temp, dens;
+    Vector<Real> ref;
+
+    const int num_rates = sizeof(AproxRates::aprox21_rates) / sizeof(int);
+
+    for ( MFIter mfi(state); mfi.isValid(); ++mfi )
+    {
+        const Box& bx = mfi.validbox();
+        auto const sp = state.const_array(mfi);
+
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+        {
+            temp.push_back(sp(i, j, k, vars.itemp));
+            dens.push_back(sp(i, j, k, vars.irho));
+            // the plotfile components are in AproxRates::rate_id order
+            for (int r = 0; r < AproxRates::NumRates; r++) {
+                for (int q = 0; q < 4; q++) {
+                    ref.push_back(sp(i, j, k, vars.ic12ag + 4*r + q));
+                }
+            }
+        });
+    }
+
+    const int npts = temp.size();
+
+    Real strt_time = ParallelDescriptor::second();
+
+    rate_table_init(AproxRates::aprox21_rates, num_rates, false, true);
+
+    Real init_time = ParallelDescriptor::second() - strt_time;
+
+    Vector<Real> rates(4 * AproxRates::NumRates * npts, 0.0);
+    Vector<Real> rates_zone(4 * AproxRates::NumRates, 0.0);
+
+    strt_time = ParallelDescriptor::second();
+
+    for (int r = 0; r < nrep; r++) {
+        for (int n = 0; n < npts; n++) {
+            aprox_rates_batch(1, &temp[n], &dens[n],
+                              AproxRates::aprox21_rates, num_rates, false,
+                              rates_zone.dataPtr());
+        }
+    }
+
+    Real direct_time = ParallelDescriptor::second() - strt_time;
+
+    int n_outside = 0;
+
+    strt_time = ParallelDescriptor::second();
+
+    for (int r = 0; r < nrep; r++) {
+        for (int n = 0; n < npts; n++) {
+            rate_table_loc_t loc;
+            if (!rate_table_locate(temp[n], loc)) {
+                n_outside++;
+                continue;
+            }
+            for (int m = 0; m < num_rates; m++) {
+                const int id = AproxRates::aprox21_rates[m];
+                Real* q = &rates[4 * (npts * id + n)];
+                rate_table_eval(loc, id, dens[n], q[0], q[1], q[2], q[3]);
+            }
+        }
+    }
+
+    Real table_time = ParallelDescriptor::second() - strt_time;
+
+    // the langanke rate at rho Ye = dens, directly and from the table
+
+    Vector<Real> lk(npts, 0.0), lk_ref(npts, 0.0);
+
+    strt_time = ParallelDescriptor::second();
+
+    for (int r = 0; r < nrep; r++) {
+        for (int n = 0; n < npts; n++) {
+            Real sn56ec;
+            langanke(temp[n], dens[n], 1.0_rt, 1.0_rt, lk_ref[n], sn56ec);
+        }
+    }
+
+    Real lk_direct_time = ParallelDescriptor::second() - strt_time;
+
+    strt_time = ParallelDescriptor::second();
+
+    for (int r = 0; r < nrep; r++) {
+        for (int n = 0; n < npts; n++) {
+            if (!rate_table_langanke(temp[n], dens[n], lk[n])) {
+                lk[n] = lk_ref[n];
+            }
+        }
+    }
+
+    Real lk_table_time = ParallelDescriptor::second() - strt_time;
+
+    // the rates are stored as rates[4 * (npts * id + n) + q], so
+    // compare them with the plotfile zone by zone
+
+    Real max_err = 0.0;
+    long n_err = 0;
+    for (int n = 0; n < npts; n++) {
+        rate_table_loc_t loc;
+        if (!rate_table_locate(temp[n], loc)) continue;
+        for (int m = 0; m < num_rates; m++) {
+            const int r = AproxRates::aprox21_rates[m];
+            for (int q = 0; q < 4; q++) {
+                Real a = rates[4 * (npts * r + n) + q];
+                Real b = ref[(n * AproxRates::NumRates + r) * 4 + q];
+                Real err = (b != 0.0) ? std::abs(a - b) / std::abs(b) : std::abs(a);
+                max_err = amrex::max(max_err, err);
+                if (err > 1.e-3_rt) n_err++;
+            }
+        }
+    }
+
+    Real lk_max_err = 0.0;
+    for (int n = 0; n < npts; n++) {
+        if (lk_ref[n] != 0.0) {
+            lk_max_err = amrex::max(lk_max_err, std::abs(lk[n] - lk_ref[n]) / lk_ref[n]);
+        }
+    }
+
+    amrex::Print() << "aprox21 rate table benchmark: " << npts << " zones x "
+                   << nrep << " repetitions, " << num_rates << " rates" << std::endl;
+    amrex::Print() << "  building the table  = " << init_time << std::endl;
+    amrex::Print() << "  direct evaluation   = " << direct_time << std::endl;
+    amrex::Print() << "  table lookup        = " << table_time << std::endl;
+    amrex::Print() << "  speedup             = " << direct_time / table_time << std::endl;
+    amrex::Print() << "  zones outside table = " << n_outside / amrex::max(nrep, 1) << std::endl;
+    amrex::Print() << "  max rel. difference from the per-zone rates = " << max_err << std::endl;
+    amrex::Print() << "  rate values differing by more than 1.e-3    = " << n_err << std::endl;
+    amrex::Print() << "  langanke: direct = " << lk_direct_time
+                   << ", table = " << lk_table_time
+                   << ", max rel. difference = " << lk_max_err << std::endl;
+
+    rate_table_finalize();
+}
+
 int main (int argc, char* argv[])
 {
     amrex::Initialize(argc, argv);
@@ -35,6 +259,9 @@ void main_main ()
 
     // AMREX_SPACEDIM: number of dimensions
     int n_cell, max_grid_size;
+    int do_batch_benchmark = 0;
+    int batch_benchmark_nrep = 10;
+    int do_table_benchmark = 0;
     Vector<int> bc_lo(AMREX_SPACEDIM,0);
     Vector<int> bc_hi(AMREX_SPACEDIM,0);
 
@@ -50,6 +277,15 @@ void main_main ()
         // The domain is broken into boxes of size max_grid_size
         max_grid_size = 32;
         pp.query("max_grid_size", max_grid_size);
+
+        // Optionally time the batched rate evaluation and check it
+        // against the per-zone rates
+        pp.query("do_batch_benchmark", do_batch_benchmark);
+        pp.query("batch_benchmark_nrep", batch_benchmark_nrep);
+
+        // Optionally time the tabulated rates against evaluating them
+        // directly, and check them against the per-zone rates
+        pp.query("do_table_benchmark", do_table_benchmark);
     }
 
     Vector<int> is_periodic(AMREX_SPACEDIM,0);
@@ -578,4 +814,12 @@ void main_main ()
     // Tell the I/O Processor to write out the "run time"
     amrex::Print() << "Run time = " << stop_time << std::endl;
 
+    if (do_batch_benchmark) {
+        batch_benchmark(state, vars, batch_benchmark_nrep);
+    }
+
+    if (do_table_benchmark) {
+        table_benchmark(state, vars, batch_benchmark_nrep);
+    }
+
 }
@@ -0,0 +1,188 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Vector.H>
+
+using namespace amrex;
+
+#include "test_burner_driver.H"
+#include "test_burner_driver_F.H"
+#include "AMReX_buildInfo.H"
+
+#include <network.H>
+#include <eos.H>
+#include <burner_driver.H>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+
+    main_main();
+
+    amrex::Finalize();
+    return 0;
+}
+
+void main_main ()
+{
+
+    int n_cell;
+
+    // inputs parameters
+    {
+        // ParmParse is way of reading inputs from the inputs file
+        ParmParse pp;
+
+        // n_cell is the number of points in density, temperature,
+        // and composition
+        pp.get("n_cell", n_cell);
+    }
+
+    // do the runtime parameter initializations and microphysics inits
+    if (ParallelDescriptor::IOProcessor()) {
+        std::cout << "reading extern runtime parameters ..." << std::endl;
+    }
+
+    ParmParse ppa("amr");
+
+    std::string probin_file = "probin";
+
+    ppa.query("probin_file", probin_file);
+
+    const int probin_file_length = probin_file.length();
+    Vector<int> probin_file_name(probin_file_length);
+
+    for (int i = 0; i < probin_file_length; i++)
+        probin_file_name[i] = probin_file[i];
+
+    init_unit_test(probin_file_name.dataPtr(), &probin_file_length);
+
+    init_extern_parameters();
+
+    eos_init();
+
+    // the zones vary in density along i, temperature along j, and
+    // composition along k, as in test_react, so their burns range from
+    // nothing happening to vigorous burning
+
+    const int nzones = n_cell * n_cell * n_cell;
+
+    Real dlogrho = 0.0e0_rt;
+    Real dlogT   = 0.0e0_rt;
+
+    if (n_cell > 1) {
+        dlogrho = (std::log10(dens_max) - std::log10(dens_min))/(n_cell - 1);
+        dlogT   = (std::log10(temp_max) - std::log10(temp_min))/(n_cell - 1);
+    }
+
+    Vector<Real> xn_k(NumSpec * n_cell);
+    get_xn_F(n_cell, xn_k.dataPtr());
+
+    Vector<Real> rho0(nzones), T0(nzones), e0(nzones), xn0(nzones * NumSpec);
+
+    for (int k = 0; k < n_cell; k++) {
+        for (int j = 0; j < n_cell; j++) {
+            for (int i = 0; i < n_cell; i++) {
+                const int n = i + n_cell * (j + n_cell * k);
+                rho0[n] = std::pow(10.0_rt, std::log10(dens_min) + static_cast<Real>(i)*dlogrho);
+                T0[n] = std::pow(10.0_rt, std::log10(temp_min) + static_cast<Real>(j)*dlogT);
+                e0[n] = 0.0_rt;
+                for (int s = 0; s < NumSpec; s++) {
+                    xn0[n * NumSpec + s] = amrex::max(xn_k[k * NumSpec + s], 1.e-10_rt);
+                }
+            }
+        }
+    }
+
+    Vector<Real> T(nzones), e(nzones), xn(nzones * NumSpec);
+    Vector<int> n_rhs(nzones), n_jac(nzones), success(nzones);
+    Vector<Real> cost(nzones);
+
+    auto reset = [&] ()
+    {
+        T = T0;
+        e = e0;
+        xn = xn0;
+    };
+
+    // the thread counts to time: powers of two up to max_threads, and
+    // what OpenMP gives us
+
+    int thread_limit = 1;
+#ifdef _OPENMP
+    thread_limit = amrex::min(omp_get_max_threads(), max_threads);
+#endif
+
+    Vector<int> thread_counts;
+    for (int nt = 1; nt <= thread_limit; nt *= 2) {
+        thread_counts.push_back(nt);
+    }
+    if (thread_counts.back() != thread_limit) {
+        thread_counts.push_back(thread_limit);
+    }
+
+    const std::string schedule_names[3] = {"static", "dynamic", "predicted"};
+    const BurnSchedule schedules[3] = {BurnSchedule::Static, BurnSchedule::Dynamic, BurnSchedule::Predicted};
+
+    amrex::Print() << "number of zones = " << nzones << std::endl;
+    amrex::Print() << std::endl;
+    amrex::Print() << "  schedule   threads   time (s)   speedup   efficiency   load balance" << std::endl;
+
+    for (int s = 0; s < 3; s++) {
+
+        Real serial_time = 0.0_rt;
+
+        for (int nt : thread_counts) {
+
+#ifdef _OPENMP
+            omp_set_num_threads(nt);
+#endif
+
+            BurnerDriver driver(schedules[s]);
+
+            // the first burn gives the predicted schedule the cost of
+            // each zone; we time the second, from the same state
+
+            reset();
+            burn_zones(driver, nzones, rho0.dataPtr(), T.dataPtr(), e.dataPtr(), xn.dataPtr(),
+                       tmax, 0.0_rt, n_rhs.dataPtr(), n_jac.dataPtr(), cost.dataPtr(), success.dataPtr());
+
+            reset();
+            burn_zones(driver, nzones, rho0.dataPtr(), T.dataPtr(), e.dataPtr(), xn.dataPtr(),
+                       tmax, 0.0_rt, n_rhs.dataPtr(), n_jac.dataPtr(), cost.dataPtr(), success.dataPtr());
+
+            if (std::any_of(success.begin(), success.end(), [] (int ok) { return ok == 0; })) {
+                amrex::Error("a zone failed to burn");
+            }
+
+            if (nt == 1) {
+                serial_time = driver.wall_time;
+            }
+
+            const Real speedup = serial_time / driver.wall_time;
+
+            amrex::Print() << "  " << std::setw(9) << schedule_names[s]
+                           << std::setw(10) << driver.thread_time.size()
+                           << std::setw(11) << std::setprecision(4) << driver.wall_time
+                           << std::setw(10) << speedup
+                           << std::setw(13) << speedup / nt
+                           << std::setw(15) << driver.load_balance() << std::endl;
+        }
+    }
+
+    const int n_rhs_min = *std::min_element(n_rhs.begin(), n_rhs.end());
+    const int n_rhs_max = *std::max_element(n_rhs.begin(), n_rhs.end());
+
+    amrex::Print() << std::endl;
+    amrex::Print() << "min number of rhs calls: " << n_rhs_min << std::endl;
+    amrex::Print() << "max number of rhs calls: " << n_rhs_max << std::endl;
+
+}
@@ -0,0 +1,37 @@
+subroutine init_unit_test(name, namlen) bind(C, name="init_unit_test")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use extern_probin_module
+  use microphysics_module
+
+  implicit none
+
+  integer, intent(in) :: namlen
+  integer, intent(in) :: name(namlen)
+
+  call runtime_init(name, namlen)
+
+  call microphysics_init(small_temp, small_dens)
+
+end subroutine init_unit_test
+
+
+
+! The compositions of the zones, from the primary species, as in
+! test_react: npts compositions going from each primary species
+! dominating to the next.
+
+subroutine get_xn_F(npts, xn) bind(C, name="get_xn_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use network, only: nspec
+  use util_module, only: get_xn
+
+  implicit none
+
+  integer, intent(in), value :: npts
+  real(rt), intent(inout) :: xn(nspec, npts)
+
+  call get_xn(npts, xn)
+
+end subroutine get_xn_F
@@ -0,0 +1,352 @@
+#include <cstdlib>
+#include <cstring>
+#include <sundials/sundials_dense.h>      /* denseGETRF, denseGETRS                   */
+#include "cvode_block_diag.H"
+
+// ---------------------------------------------------------------------
+// block-diagonal SUNMatrix
+// ---------------------------------------------------------------------
+
+static SUNMatrix_ID block_diag_getid(SUNMatrix A)
+{
+  return SUNMATRIX_CUSTOM;
+}
+
+
+static SUNMatrix block_diag_clone(SUNMatrix A)
+{
+  return SUNBlockDiagMatrix(BLOCKDIAG_BLOCK_SIZE(A), BLOCKDIAG_NUM_BLOCKS(A));
+}
+
+
+static void block_diag_destroy(SUNMatrix A)
+{
+  if (A == NULL) return;
+
+  if (A->content != NULL) {
+    std::free(BLOCKDIAG_CONTENT(A)->data);
+    std::free(BLOCKDIAG_CONTENT(A)->cols);
+    std::free(A->content);
+    A->content = NULL;
+  }
+
+  std::free(A->ops);
+  std::free(A);
+}
+
+
+static int block_diag_zero(SUNMatrix A)
+{
+  const sunindextype ldata = BLOCKDIAG_CONTENT(A)->ldata;
+  realtype* data = BLOCKDIAG_DATA(A);
+  for (sunindextype i = 0; i < ldata; i++) {
+    data[i] = 0.0;
+  }
+  return SUNMAT_SUCCESS;
+}
+
+
+static bool block_diag_compatible(SUNMatrix A, SUNMatrix B)
+{
+  if (B->ops->getid != block_diag_getid) return false;
+  if (BLOCKDIAG_BLOCK_SIZE(A) != BLOCKDIAG_BLOCK_SIZE(B)) return false;
+  if (BLOCKDIAG_NUM_BLOCKS(A) != BLOCKDIAG_NUM_BLOCKS(B)) return false;
+  return true;
+}
+
+
+static int block_diag_copy(SUNMatrix A, SUNMatrix B)
+{
+  // B = A
+  if (!block_diag_compatible(A, B)) return SUNMAT_ILL_INPUT;
+  std::memcpy(BLOCKDIAG_DATA(B), BLOCKDIAG_DATA(A),
+              BLOCKDIAG_CONTENT(A)->ldata * sizeof(realtype));
+  return SUNMAT_SUCCESS;
+}
+
+
+static int block_diag_scale_add(realtype c, SUNMatrix A, SUNMatrix B)
+{
+  // A = c*A + B
+  if (!block_diag_compatible(A, B)) return SUNMAT_ILL_INPUT;
+  const sunindextype ldata = BLOCKDIAG_CONTENT(A)->ldata;
+  realtype* a = BLOCKDIAG_DATA(A);
+  const realtype* b = BLOCKDIAG_DATA(B);
+  for (sunindextype i = 0; i < ldata; i++) {
+    a[i] = c * a[i] + b[i];
+  }
+  return SUNMAT_SUCCESS;
+}
+
+
+static int block_diag_scale_add_identity(realtype c, SUNMatrix A)
+{
+  // A = c*A + I
+  const sunindextype ldata = BLOCKDIAG_CONTENT(A)->ldata;
+  const sunindextype n = BLOCKDIAG_BLOCK_SIZE(A);
+  realtype* a = BLOCKDIAG_DATA(A);
+  for (sunindextype i = 0; i < ldata; i++) {
+    a[i] = c * a[i];
+  }
+  for (sunindextype b = 0; b < BLOCKDIAG_NUM_BLOCKS(A); b++) {
+    realtype* block = BLOCKDIAG_BLOCK(A, b);
+    for (sunindextype j = 0; j < n; j++) {
+      block[j*n + j] += 1.0;
+    }
+  }
+  return SUNMAT_SUCCESS;
+}
+
+
+static int block_diag_matvec(SUNMatrix A, N_Vector x, N_Vector y)
+{
+  // y = A x, one block at a time
+  const sunindextype n = BLOCKDIAG_BLOCK_SIZE(A);
+  const realtype* xd = N_VGetArrayPointer(x);
+  realtype* yd = N_VGetArrayPointer(y);
+  if (xd == NULL || yd == NULL || xd == yd) return SUNMAT_ILL_INPUT;
+
+  for (sunindextype b = 0; b < BLOCKDIAG_NUM_BLOCKS(A); b++) {
+    const realtype* block = BLOCKDIAG_BLOCK(A, b);
+    const realtype* xb = &xd[b*n];
+    realtype* yb = &yd[b*n];
+    for (sunindextype i = 0; i < n; i++) {
+      yb[i] = 0.0;
+    }
+    for (sunindextype j = 0; j < n; j++) {
+      for (sunindextype i = 0; i < n; i++) {
+        yb[i] += block[j*n + i] * xb[j];
+      }
+    }
+  }
+  return SUNMAT_SUCCESS;
+}
+
+
+static int block_diag_space(SUNMatrix A, long int* lenrw, long int* leniw)
+{
+  *lenrw = BLOCKDIAG_CONTENT(A)->ldata;
+  *leniw = 3;
+  return SUNMAT_SUCCESS;
+}
+
+
+SUNMatrix SUNBlockDiagMatrix(sunindextype block_size, sunindextype num_blocks)
+{
+  if (block_size <= 0 || num_blocks <= 0) return NULL;
+
+  SUNMatrix A = static_cast<SUNMatrix>(std::calloc(1, sizeof(*A)));
+  if (A == NULL) return NULL;
+
+  // calloc so that any ops we don't provide are NULL
+  A->ops = static_cast<SUNMatrix_Ops>(std::calloc(1, sizeof(*(A->ops))));
+  if (A->ops == NULL) { std::free(A); return NULL; }
+
+  A->ops->getid     = block_diag_getid;
+  A->ops->clone     = block_diag_clone;
+  A->ops->destroy   = block_diag_destroy;
+  A->ops->zero      = block_diag_zero;
+  A->ops->copy      = block_diag_copy;
+  A->ops->scaleadd  = block_diag_scale_add;
+  A->ops->scaleaddi = block_diag_scale_add_identity;
+  A->ops->matvec    = block_diag_matvec;
+  A->ops->space     = block_diag_space;
+
+  BlockDiagMatrixContent* content =
+    static_cast<BlockDiagMatrixContent*>(std::malloc(sizeof(BlockDiagMatrixContent)));
+  if (content == NULL) { std::free(A->ops); std::free(A); return NULL; }
+
+  content->block_size = block_size;
+  content->num_blocks = num_blocks;
+  content->ldata = block_size * block_size * num_blocks;
+  content->data = static_cast<realtype*>(std::calloc(content->ldata, sizeof(realtype)));
+
+  // column pointers for every block, as expected by denseGETRF/denseGETRS
+  content->cols = static_cast<realtype**>(std::malloc(block_size * num_blocks * sizeof(realtype*)));
+
+  A->content = content;
+
+  if (content->data == NULL || content->cols == NULL) {
+    block_diag_destroy(A);
+    return NULL;
+  }
+
+  for (sunindextype j = 0; j < block_size * num_blocks; j++) {
+    content->cols[j] = content->data + j * block_size;
+  }
+
+  return A;
+}
+
+
+realtype* SUNBlockDiagMatrix_Block(SUNMatrix A, sunindextype block_id)
+{
+  return BLOCKDIAG_BLOCK(A, block_id);
+}
+
+
+// ---------------------------------------------------------------------
+// block-diagonal direct linear solver
+// ---------------------------------------------------------------------
+
+#define BLOCKDIAG_LS_CONTENT(S)  ( (BlockDiagLinSolContent*)(S->content) )
+
+static SUNLinearSolver_Type block_diag_ls_gettype(SUNLinearSolver S)
+{
+  return SUNLINEARSOLVER_DIRECT;
+}
+
+
+static int block_diag_ls_initialize(SUNLinearSolver S)
+{
+  BLOCKDIAG_LS_CONTENT(S)->last_flag = SUNLS_SUCCESS;
+  return SUNLS_SUCCESS;
+}
+
+
+static int block_diag_ls_setup(SUNLinearSolver S, SUNMatrix A)
+{
+  // LU-factor each block in place, with partial pivoting
+  BlockDiagLinSolContent* content = BLOCKDIAG_LS_CONTENT(S);
+
+  if (A == NULL || A->ops->getid != block_diag_getid ||
+      BLOCKDIAG_BLOCK_SIZE(A) != content->block_size ||
+      BLOCKDIAG_NUM_BLOCKS(A) != content->num_blocks) {
+    content->last_flag = SUNLS_ILL_INPUT;
+    return SUNLS_ILL_INPUT;
+  }
+
+  const sunindextype n = content->block_size;
+  realtype** cols = BLOCKDIAG_CONTENT(A)->cols;
+
+  content->last_flag = SUNLS_SUCCESS;
+
+  for (sunindextype b = 0; b < content->num_blocks; b++) {
+    sunindextype ierr = denseGETRF(&cols[b*n], n, n, &content->pivots[b*n]);
+    content->num_block_factorizations++;
+    if (ierr > 0) {
+      // a zero pivot in block b -- report the global column, like the
+      // dense solver does
+      content->last_flag = b*n + ierr;
+      return SUNLS_LUFACT_FAIL;
+    }
+  }
+
+  return SUNLS_SUCCESS;
+}
+
+
+static int block_diag_ls_solve(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                               N_Vector b, realtype tol)
+{
+  BlockDiagLinSolContent* content = BLOCKDIAG_LS_CONTENT(S);
+
+  if (A == NULL || x == NULL || b == NULL) {
+    content->last_flag = SUNLS_MEM_NULL;
+    return SUNLS_MEM_NULL;
+  }
+
+  // copy b into x and solve in place, one block at a time
+  N_VScale(1.0, b, x);
+
+  realtype* xd = N_VGetArrayPointer(x);
+  if (xd == NULL) {
+    content->last_flag = SUNLS_MEM_FAIL;
+    return SUNLS_MEM_FAIL;
+  }
+
+  const sunindextype n = content->block_size;
+  realtype** cols = BLOCKDIAG_CONTENT(A)->cols;
+
+  for (sunindextype blk = 0; blk < content->num_blocks; blk++) {
+    denseGETRS(&cols[blk*n], n, &content->pivots[blk*n], &xd[blk*n]);
+  }
+
+  content->num_solves++;
+  content->last_flag = SUNLS_SUCCESS;
+  return SUNLS_SUCCESS;
+}
+
+
+static long int block_diag_ls_lastflag(SUNLinearSolver S)
+{
+  return BLOCKDIAG_LS_CONTENT(S)->last_flag;
+}
+
+
+static int block_diag_ls_space(SUNLinearSolver S, long int* lenrwLS, long int* leniwLS)
+{
+  *lenrwLS = 0;
+  *leniwLS = 2 + BLOCKDIAG_LS_CONTENT(S)->block_size * BLOCKDIAG_LS_CONTENT(S)->num_blocks;
+  return SUNLS_SUCCESS;
+}
+
+
+static int block_diag_ls_free(SUNLinearSolver S)
+{
+  if (S == NULL) return SUNLS_SUCCESS;
+
+  if (S->content != NULL) {
+    std::free(BLOCKDIAG_LS_CONTENT(S)->pivots);
+    std::free(S->content);
+    S->content = NULL;
+  }
+
+  std::free(S->ops);
+  std::free(S);
+  return SUNLS_SUCCESS;
+}
+
+
+SUNLinearSolver SUNBlockDiagLinearSolver(N_Vector y, SUNMatrix A)
+{
+  if (A == NULL || A->ops->getid != block_diag_getid) return NULL;
+  if (N_VGetArrayPointer(y) == NULL) return NULL;
+
+  SUNLinearSolver S = static_cast<SUNLinearSolver>(std::calloc(1, sizeof(*S)));
+  if (S == NULL) return NULL;
+
+  // calloc so that any ops we don't provide are NULL
+  S->ops = static_cast<SUNLinearSolver_Ops>(std::calloc(1, sizeof(*(S->ops))));
+  if (S->ops == NULL) { std::free(S); return NULL; }
+
+  S->ops->gettype    = block_diag_ls_gettype;
+  S->ops->initialize = block_diag_ls_initialize;
+  S->ops->setup      = block_diag_ls_setup;
+  S->ops->solve      = block_diag_ls_solve;
+  S->ops->lastflag   = block_diag_ls_lastflag;
+  S->ops->space      = block_diag_ls_space;
+  S->ops->free       = block_diag_ls_free;
+
+  BlockDiagLinSolContent* content =
+    static_cast<BlockDiagLinSolContent*>(std::malloc(sizeof(BlockDiagLinSolContent)));
+  if (content == NULL) { std::free(S->ops); std::free(S); return NULL; }
+
+  content->block_size = BLOCKDIAG_BLOCK_SIZE(A);
+  content->num_blocks = BLOCKDIAG_NUM_BLOCKS(A);
+  content->last_flag = 0;
+  content->num_block_factorizations = 0;
+  content->num_solves = 0;
+  content->pivots = static_cast<sunindextype*>(std::malloc(content->block_size * content->num_blocks *
+                                                           sizeof(sunindextype)));
+  S->content = content;
+
+  if (content->pivots == NULL) {
+    block_diag_ls_free(S);
+    return NULL;
+  }
+
+  return S;
+}
+
+
+long int SUNBlockDiagLinearSolver_NumBlockFactorizations(SUNLinearSolver S)
+{
+  return BLOCKDIAG_LS_CONTENT(S)->num_block_factorizations;
+}
+
+
+long int SUNBlockDiagLinearSolver_NumSolves(SUNLinearSolver S)
+{
+  return BLOCKDIAG_LS_CONTENT(S)->num_solves;
+}
@@ -25,12 +25,127 @@ int main (int argc, char* argv[])
     return 0;
 }
 
+void react_state(MultiFab& state, const IntVect& tile_size,
+                 const Real tmax, const int Ncomp, const int linear_solver,
+                 const int batch_mode, ReactStats& stats)
+{
+    // What time is it now?  We'll use this to compute total react time.
+    Real strt_time = ParallelDescriptor::second();
+
+    // Do the reactions
+    if (batch_mode == CVODE_BATCH_PER_ZONE) {
+
+#ifdef AMREX_USE_CUDA
+        amrex::Abort("batch_mode = per_zone is only available with the serial interface");
+#else
+        // do_react_per_zone threads over the zones of each box itself
+        for ( MFIter mfi(state); mfi.isValid(); ++mfi )
+        {
+            const Box& bx = mfi.validbox();
+
+            do_react_per_zone(AMREX_ARLIM_3D(bx.loVect()), AMREX_ARLIM_3D(bx.hiVect()),
+                              BL_TO_FORTRAN_ANYD(state[mfi]), Ncomp, tmax, stats);
+        }
+#endif
+
+    } else {
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            long n_rhs = 0;
+            long n_jac = 0;
+            long n_linsetup = 0;
+            long n_steps = 0;
+
+            ReactStats thread_stats;
+
+            for ( MFIter mfi(state, tile_size); mfi.isValid(); ++mfi )
+            {
+                const Box& bx = mfi.tilebox();
+
+                do_react(AMREX_ARLIM_3D(bx.loVect()), AMREX_ARLIM_3D(bx.hiVect()),
+                         BL_TO_FORTRAN_ANYD(state[mfi]), Ncomp, tmax, linear_solver,
+                         &n_rhs, &n_jac, &n_linsetup, &n_steps);
+
+                thread_stats.add_box(n_rhs, n_jac, n_linsetup);
+
+                // every zone in the box took every step and was
+                // evaluated in every RHS call
+                for (long n = 0; n < bx.numPts(); n++) {
+                    thread_stats.add_zone(n_steps, n_rhs);
+                }
+            }
+
+#ifdef _OPENMP
+#pragma omp critical (react_stats_merge)
+#endif
+            stats.merge(thread_stats);
+        }
+
+    }
+
+    // Call the timer again and compute the maximum difference between
+    // the start time and stop time over all processors
+    Real stop_time = ParallelDescriptor::second() - strt_time;
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceRealMax(stop_time, IOProc);
+
+    stats.run_time = stop_time;
+}
+
+void print_react_stats(const ReactStats& stats)
+{
+    std::cout << "min number of rhs calls: " << stats.n_rhs_min << std::endl;
+    std::cout << "avg number of rhs calls: " << stats.n_rhs_sum / stats.n_reacting_boxes << std::endl;
+    std::cout << "max number of rhs calls: " << stats.n_rhs_max << std::endl;
+
+    std::cout << "min number of jac calls: " << stats.n_jac_min << std::endl;
+    std::cout << "avg number of jac calls: " << stats.n_jac_sum / stats.n_reacting_boxes << std::endl;
+    std::cout << "max number of jac calls: " << stats.n_jac_max << std::endl;
+
+    std::cout << "min number of linear solver setup calls: " << stats.n_linsetup_min << std::endl;
+    std::cout << "avg number of linear solver setup calls: " << stats.n_linsetup_sum / stats.n_reacting_boxes << std::endl;
+    std::cout << "max number of linear solver setup calls: " << stats.n_linsetup_max << std::endl;
+
+    if (stats.n_zones > 0) {
+      const Real zone_rhs_avg = static_cast<Real>(stats.n_zone_rhs_sum) / stats.n_zones;
+      const Real zone_steps_avg = static_cast<Real>(stats.n_zone_steps_sum) / stats.n_zones;
+
+      std::cout << "min number of rhs evaluations per zone: " << stats.n_zone_rhs_min << std::endl;
+      std::cout << "avg number of rhs evaluations per zone: " << zone_rhs_avg << std::endl;
+      std::cout << "max number of rhs evaluations per zone: " << stats.n_zone_rhs_max << std::endl;
+      std::cout << "total number of zone rhs evaluations: " << stats.n_zone_rhs_sum << std::endl;
+
+      std::cout << "min number of steps per zone: " << stats.n_zone_steps_min << std::endl;
+      std::cout << "avg number of steps per zone: " << zone_steps_avg << std::endl;
+      std::cout << "max number of steps per zone: " << stats.n_zone_steps_max << std::endl;
+
+      // ratio of the most expensive zone to the average one
+      std::cout << "zone rhs load imbalance (max/avg): " << stats.n_zone_rhs_max / zone_rhs_avg << std::endl;
+    }
+
+    if (stats.n_thread_imbalance_boxes > 0) {
+      // the max/avg thread time is found for each box, since the
+      // threads only share the zones of one box at a time
+      const Real thread_imbalance_avg = stats.thread_imbalance_sum / stats.n_thread_imbalance_boxes;
+      std::cout << "avg thread load imbalance per box (max/avg time): " << thread_imbalance_avg << std::endl;
+      std::cout << "max thread load imbalance per box (max/avg time): " << stats.thread_imbalance_max << std::endl;
+    }
+}
+
 void main_main ()
 {
 
     // AMREX_SPACEDIM: number of dimensions
     int n_cell, max_grid_size;
     amrex::Real tmax;
+    int linear_solver = CVODE_LINSOLVE_DENSE;
+    int compare_linear_solvers = 0;
+    int max_dense_compare_zones = 512;
+    int batch_mode = CVODE_BATCH_SINGLE_SYSTEM;
+    int compare_batch_modes = 0;
     Vector<int> bc_lo(AMREX_SPACEDIM,0);
     Vector<int> bc_hi(AMREX_SPACEDIM,0);
 
@@ -56,6 +171,41 @@ void main_main ()
 
         pp.query("prefix", prefix);
 
+        // Which linear solver CVODE uses for the batched system:
+        // "dense" (the full matrix) or "block_diag" (one block per zone)
+        std::string linear_solver_name = "dense";
+        pp.query("linear_solver", linear_solver_name);
+        if (linear_solver_name == "dense") {
+          linear_solver = CVODE_LINSOLVE_DENSE;
+        } else if (linear_solver_name == "block_diag") {
+          linear_solver = CVODE_LINSOLVE_BLOCK_DIAG;
+        } else {
+          amrex::Abort("Unknown linear_solver: " + linear_solver_name);
+        }
+
+        // Also time the dense linear solver on a copy of the state?
+        pp.query("compare_linear_solvers", compare_linear_solvers);
+
+        // The dense matrix for a box of n zones has (neqs*n)**2
+        // entries, so the comparison is only done if no box has more
+        // than this many zones
+        pp.query("max_dense_compare_zones", max_dense_compare_zones);
+
+        // Integrate each box as one system ("single_system") or each
+        // zone independently ("per_zone")
+        std::string batch_mode_name = "single_system";
+        pp.query("batch_mode", batch_mode_name);
+        if (batch_mode_name == "single_system") {
+          batch_mode = CVODE_BATCH_SINGLE_SYSTEM;
+        } else if (batch_mode_name == "per_zone") {
+          batch_mode = CVODE_BATCH_PER_ZONE;
+        } else {
+          amrex::Abort("Unknown batch_mode: " + batch_mode_name);
+        }
+
+        // Also react a copy of the state as one system per box?
+        pp.query("compare_batch_modes", compare_batch_modes);
+
     }
 
     Vector<int> is_periodic(AMREX_SPACEDIM,0);
@@ -162,66 +312,59 @@ void main_main ()
       std::cout << "finished initializing state ..." << std::endl;
     }
 
-    // Variables to store the integration statistics
-    long n_rhs_min = 100000000;
-    long n_rhs_max = 0;
-    long n_rhs_sum = 0;
-
-    long n_jac_min = 100000000;
-    long n_jac_max = 0;
-    long n_jac_sum = 0;
-
-    long n_linsetup_min = 100000000;
-    long n_linsetup_max = 0;
-    long n_linsetup_sum = 0;
-
-    long n_rhs = 0;
-    long n_jac = 0;
-    long n_linsetup = 0;
-
-    int n_reacting_boxes = 0;
-
     if (ParallelDescriptor::IOProcessor()) {
       std::cout << "reacting state with timestep " << tmax << " ..." << std::endl;
     }
 
-    // What time is it now?  We'll use this to compute total react time.
-    Real strt_time = ParallelDescriptor::second();
+    // The dense matrix for a large box integrated as one system will
+    // not fit in memory.
+    if (compare_linear_solvers && linear_solver != CVODE_LINSOLVE_DENSE &&
+        batch_mode == CVODE_BATCH_SINGLE_SYSTEM) {
+      Long max_box_zones = 0;
+      for (int i = 0; i < ba.size(); ++i) {
+        max_box_zones = amrex::max(max_box_zones, ba[i].numPts());
+      }
 
-    // Do the reactions
-#ifdef _OPENMP
-#pragma omp parallel threadprivate(n_rhs, n_jac, n_linsetup)
-#pragma omp reduction(+: n_rhs_sum, n_jac_sum, n_linsetup_sum, n_reacting_boxes)
-#pragma omp reduction(max: n_rhs_max, n_jac_max, n_linsetup_max)
-#pragma omp reduction(min: n_rhs_min, n_jac_min, n_linsetup_min)
-#endif
-    for ( MFIter mfi(state, tile_size); mfi.isValid(); ++mfi )
-    {
-        const Box& bx = mfi.tilebox();
+      if (max_box_zones > max_dense_compare_zones) {
+        amrex::Print() << "Skipping the dense linear solver comparison: the largest box has "
+                       << max_box_zones << " zones, more than max_dense_compare_zones = "
+                       << max_dense_compare_zones << std::endl;
+        compare_linear_solvers = 0;
+      }
+    }
+
+    // If requested, first react a copy of the state with the dense
+    // linear solver so we can compare timings against the solver
+    // selected in the inputs.
+    if (compare_linear_solvers && linear_solver != CVODE_LINSOLVE_DENSE) {
+      MultiFab state_dense(ba, dm, Ncomp, Nghost);
+      MultiFab::Copy(state_dense, state, 0, 0, Ncomp, Nghost);
 
-        do_react(AMREX_ARLIM_3D(bx.loVect()), AMREX_ARLIM_3D(bx.hiVect()),
-		 BL_TO_FORTRAN_ANYD(state[mfi]), Ncomp, tmax, &n_rhs, &n_jac, &n_linsetup);
+      ReactStats stats_dense;
+      react_state(state_dense, tile_size, tmax, Ncomp, CVODE_LINSOLVE_DENSE,
+                  batch_mode, stats_dense);
 
-	n_rhs_sum += n_rhs;
-	n_rhs_max = std::max(n_rhs_max, n_rhs);
-	n_rhs_min = std::min(n_rhs_min, n_rhs);
+      amrex::Print() << "Run time with the dense linear solver = " << stats_dense.run_time << std::endl;
+      print_react_stats(stats_dense);
+    }
 
-	n_jac_sum += n_jac;
-	n_jac_max = std::max(n_jac_max, n_jac);
-	n_jac_min = std::min(n_jac_min, n_jac);
+    // Likewise, compare the per-zone mode against integrating each
+    // box as a single system.
+    if (compare_batch_modes && batch_mode != CVODE_BATCH_SINGLE_SYSTEM) {
+      MultiFab state_single(ba, dm, Ncomp, Nghost);
+      MultiFab::Copy(state_single, state, 0, 0, Ncomp, Nghost);
 
-	n_linsetup_sum += n_linsetup;
-	n_linsetup_max = std::max(n_linsetup_max, n_linsetup);
-	n_linsetup_min = std::min(n_linsetup_min, n_linsetup);
+      ReactStats stats_single;
+      react_state(state_single, tile_size, tmax, Ncomp, linear_solver,
+                  CVODE_BATCH_SINGLE_SYSTEM, stats_single);
 
-	n_reacting_boxes++;
+      amrex::Print() << "Run time integrating each box as one system = " << stats_single.run_time << std::endl;
+      print_react_stats(stats_single);
     }
 
-    // Call the timer again and compute the maximum difference between
-    // the start time and stop time over all processors
-    Real stop_time = ParallelDescriptor::second() - strt_time;
-    const int IOProc = ParallelDescriptor::IOProcessorNumber();
-    ParallelDescriptor::ReduceRealMax(stop_time, IOProc);
+    ReactStats stats;
+    react_state(state, tile_size, tmax, Ncomp, linear_solver, batch_mode, stats);
+    Real stop_time = stats.run_time;
 
     if (ParallelDescriptor::IOProcessor()) {
       std::cout << "finished reacting state ..." << std::endl;
@@ -252,15 +395,5 @@ void main_main ()
     amrex::Print() << "Run time = " << stop_time << std::endl;
 
     // print statistics
-    std::cout << "min number of rhs calls: " << n_rhs_min << std::endl;
-    std::cout << "avg number of rhs calls: " << n_rhs_sum / n_reacting_boxes << std::endl;
-    std::cout << "max number of rhs calls: " << n_rhs_max << std::endl;
-
-    std::cout << "min number of jac calls: " << n_jac_min << std::endl;
-    std::cout << "avg number of jac calls: " << n_jac_sum / n_reacting_boxes << std::endl;
-    std::cout << "max number of jac calls: " << n_jac_max << std::endl;
-
-    std::cout << "min number of linear solver setup calls: " << n_linsetup_min << std::endl;
-    std::cout << "avg number of linear solver setup calls: " << n_linsetup_sum / n_reacting_boxes << std::endl;
-    std::cout << "max number of linear solver setup calls: " << n_linsetup_max << std::endl;
+    print_react_stats(stats);
 }
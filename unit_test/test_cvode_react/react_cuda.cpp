@@ -13,8 +13,8 @@ using namespace amrex;
 
 void do_react(const int* lo, const int* hi,
 	      amrex::Real* state, const int* s_lo, const int* s_hi,
-	      const int ncomp, const amrex::Real dt,
-	      long* n_rhs, long* n_jac, long* n_linsetup)
+	      const int ncomp, const amrex::Real dt, const int linear_solver,
+	      long* n_rhs, long* n_jac, long* n_linsetup, long* n_steps)
 {
   const int size_x = hi[0]-lo[0]+1;
   const int size_y = hi[1]-lo[1]+1;
@@ -156,6 +156,7 @@ void do_react(const int* lo, const int* hi,
   flag = CVodeGetNumRhsEvals(cvode_mem, n_rhs);
   flag = CVSpilsGetNumJtimesEvals(cvode_mem, n_jac);
   flag = CVodeGetNumLinSolvSetups(cvode_mem, n_linsetup);
+  flag = CVodeGetNumSteps(cvode_mem, n_steps);
   
   // Get Final State
   get_nvector_cuda(yout, &state_y[0], size_flat);
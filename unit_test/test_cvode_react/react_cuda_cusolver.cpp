@@ -16,8 +16,8 @@ using namespace amrex;
 
 void do_react(const int* lo, const int* hi,
 	      amrex::Real* state, const int* s_lo, const int* s_hi,
-	      const int ncomp, const amrex::Real dt,
-	      long* n_rhs, long* n_jac, long* n_linsetup)
+	      const int ncomp, const amrex::Real dt, const int linear_solver,
+	      long* n_rhs, long* n_jac, long* n_linsetup, long* n_steps)
 {
   const int size_x = hi[0]-lo[0]+1;
   const int size_y = hi[1]-lo[1]+1;
@@ -218,6 +218,7 @@ void do_react(const int* lo, const int* hi,
   flag = cv_cuSolver_GetNumJacEvals(cvode_mem, &n_actual_jac);
   *n_jac = n_actual_jac;
   flag = CVodeGetNumLinSolvSetups(cvode_mem, n_linsetup);
+  flag = CVodeGetNumSteps(cvode_mem, n_steps);
 
 #if PRINT_DEBUG
   std::cout << "Desired end time = " << time << std::endl;
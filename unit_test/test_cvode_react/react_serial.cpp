@@ -8,6 +8,7 @@
 #include "sunmatrix/sunmatrix_dense.h"        /* access to dense SUNMatrix                */
 #include "sunlinsol/sunlinsol_dense.h"        /* access to dense SUNLinearSolver          */
 #include "cvode/cvode_direct.h"           /* access to CVDls interface                */
+#include "cvode_block_diag.H"             /* block-diagonal SUNMatrix/SUNLinearSolver */
 #endif
 #include <sundials/sundials_types.h>      /* definition of realtype                   */
 #include <sundials/sundials_math.h>       /* contains the macros ABS, SUNSQR, and EXP */
@@ -15,211 +16,463 @@
 #include "test_react.H"
 #include "test_react_F.H"
 #include <iostream>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace amrex;
 
-void do_react(const int* lo, const int* hi,
-	      amrex::Real* state, const int* s_lo, const int* s_hi,
-	      const int ncomp, const amrex::Real dt,
-	      long* n_rhs, long* n_jac, long* n_linsetup)
+// Indices into the state and the sizes of the per-zone ODE system,
+// queried from the Fortran side once per box.
+struct ReactIndices {
+  int idx_spec, idx_spec_old, idx_dens, idx_temp, idx_omegadot, idx_dens_hnuc;
+  int neqs, nspec_evolve, nspec_not_evolved, size_rpar_per_cell;
+
+  void fill()
+  {
+    get_species_index(&idx_spec);
+    get_species_old_index(&idx_spec_old);
+    get_density_index(&idx_dens);
+    get_temperature_index(&idx_temp);
+    get_omegadot_index(&idx_omegadot);
+    get_density_hnuc_index(&idx_dens_hnuc);
+
+    get_number_equations(&neqs, &nspec_not_evolved);
+    sk_get_nspec_evolve(&nspec_evolve);
+    sk_get_num_rpar_comps(&size_rpar_per_cell);
+  }
+};
+
+
+// Copy zone (i,j,k) of the state into slot nzone of the integration
+// vector y and the user data, and set its absolute tolerances.
+static void load_zone(const ReactIndices& ri,
+		      amrex::Real* state, const int* s_lo, const int* s_hi,
+		      const int ncomp, const int i, const int j, const int k,
+		      const int nzone, realtype* y, realtype* abstol_values,
+		      CVodeUserData* user_data)
 {
-  const int size_x = hi[0]-lo[0]+1;
-  const int size_y = hi[1]-lo[1]+1;
-  const int size_z = hi[2]-lo[2]+1;
-  const int size_state = size_x * size_y * size_z;
+  realtype* yz = &y[nzone*ri.neqs];
+  realtype* abstol_z = &abstol_values[nzone*ri.neqs];
+  amrex::Real* rpar_z = &user_data->rpar[nzone*user_data->num_rpar_per_cell];
+
+  // Put mass fractions into integration vector
+  int scomp = 0;
+  for (int n=ri.idx_spec_old; n<ri.idx_spec_old+ri.nspec_evolve; n++) {
+    get_state(state, s_lo, s_hi, ncomp, i, j, k, n, &yz[scomp]);
+    abstol_z[scomp] = 1.0e-12;
+    scomp++;
+  }
+
+  // Temperature absolute tolerance
+  abstol_z[ri.nspec_evolve] = 1.0e-6;
+
+  // Energy absolute tolerance
+  abstol_z[ri.nspec_evolve + 1] = 1.0e-6;
+
+  // Put temperature into integration vector
+  get_state(state, s_lo, s_hi, ncomp, i, j, k, ri.idx_temp, &yz[ri.nspec_evolve]);
+
+  // Initialize energy to 0, we'll get it from the EOS
+  yz[ri.nspec_evolve + 1] = 0.0e0;
+
+  // Put density in user data
+  get_state(state, s_lo, s_hi, ncomp, i, j, k, ri.idx_dens, &rpar_z[user_data->irp_dens]);
+
+  // Put unevolved mass fractions in user data
+  scomp=0;
+  for (int n=ri.idx_spec_old+ri.nspec_evolve; n<ri.idx_spec_old+ri.nspec_evolve+ri.nspec_not_evolved; n++) {
+    get_state(state, s_lo, s_hi, ncomp, i, j, k, n,
+	      &rpar_z[user_data->irp_xn_not_evolved + scomp]);
+    scomp++;
+  }
+
+  // Set zone size dx in rpar(irp_dx)
+  rpar_z[user_data->irp_dx] = 1.0;
+
+  // Set time offset to the simulation time of 0
+  rpar_z[user_data->irp_t0] = 0.0;
+}
+
+
+// Copy slot nzone of the finalized integration vector back into zone
+// (i,j,k) of the state, along with omegadot and rho*Hnuc.
+static void store_zone(const ReactIndices& ri,
+		       amrex::Real* state, const int* s_lo, const int* s_hi,
+		       const int ncomp, const int i, const int j, const int k,
+		       const int nzone, const realtype* y,
+		       const CVodeUserData* user_data, const amrex::Real dt)
+{
+  const realtype* yz = &y[nzone*ri.neqs];
+  const amrex::Real* rpar_z = &user_data->rpar[nzone*user_data->num_rpar_per_cell];
+
+  // Put evolved mass fractions into state
+  int scomp = 0;
+  for (int n=ri.idx_spec; n<ri.idx_spec+ri.nspec_evolve; n++) {
+    set_state(state, s_lo, s_hi, ncomp, i, j, k, n, yz[scomp]);
+    scomp++;
+  }
+
+  // Put unevolved mass fractions into state
+  scomp=0;
+  for (int n=ri.idx_spec+ri.nspec_evolve; n<ri.idx_spec+ri.nspec_evolve+ri.nspec_not_evolved; n++) {
+    set_state(state, s_lo, s_hi, ncomp, i, j, k, n,
+	      rpar_z[user_data->irp_xn_not_evolved + scomp]);
+    scomp++;
+  }
+
+  // Put omegadot into state
+  amrex::Real xn_start, xn_final, wscratch;
+  scomp = 0;
+  int n_spec_old;
+  for (int n=ri.idx_omegadot; n<ri.idx_omegadot+ri.nspec_evolve+ri.nspec_not_evolved; n++) {
+    n_spec_old = n-ri.idx_omegadot+ri.idx_spec_old;
+    get_state(state, s_lo, s_hi, ncomp, i, j, k, n_spec_old, &xn_start);
+    if (scomp < ri.nspec_evolve) {
+      xn_final = yz[scomp];
+    } else {
+      xn_final = rpar_z[user_data->irp_xn_not_evolved + scomp - ri.nspec_evolve];
+    }
+    wscratch = (xn_final - xn_start)/dt;
+    set_state(state, s_lo, s_hi, ncomp, i, j, k, n, wscratch);
+    scomp++;
+  }
+
+  // Set rho*Hnuc
+  get_state(state, s_lo, s_hi, ncomp, i, j, k, ri.idx_dens, &wscratch);
+  wscratch = wscratch * yz[ri.nspec_evolve + 1]/dt;
+  set_state(state, s_lo, s_hi, ncomp, i, j, k, ri.idx_dens_hnuc, wscratch);
+}
 
-  int idx_spec, idx_spec_old, idx_dens, idx_temp, idx_omegadot, idx_dens_hnuc;
 
-  get_species_index(&idx_spec);
-  get_species_old_index(&idx_spec_old);
-  get_density_index(&idx_dens);
-  get_temperature_index(&idx_temp);
-  get_omegadot_index(&idx_omegadot);
-  get_density_hnuc_index(&idx_dens_hnuc);
+// A CVODE system pre-sized for num_cells zones of neqs equations each.
+//
+// Creating the CVODE memory, N_Vectors, matrix and linear solver is
+// expensive compared to reacting a small box, and we react every box
+// every step, so each thread keeps a pool of these keyed by the shape
+// of the system and reinitializes them with CVodeReInit.
+class CVodeWorkspace {
 
-  int neqs, nspec_not_evolved, size_flat;
+public:
 
-  get_number_equations(&neqs, &nspec_not_evolved);
-  size_flat = neqs * size_state;
-  int nspec_evolve;
-  sk_get_nspec_evolve(&nspec_evolve);
-  int size_rpar_per_cell;
-  sk_get_num_rpar_comps(&size_rpar_per_cell);
-  const int size_rpar = size_rpar_per_cell * size_state;
+  const int num_cells;
+  const int num_eqs_per_cell;
+  const int size_flat;
+  const int linear_solver;
+
+  const realtype reltol = 1.0e-6;
 
   CVodeUserData* user_data;
-  user_data = static_cast<CVodeUserData*>(std::malloc(sizeof(CVodeUserData)));
 
-  new (user_data) CVodeUserData(size_flat, size_state, neqs,
-				size_rpar_per_cell, 0,
-				nspec_not_evolved);
+  std::vector<realtype> state_y;
+  std::vector<realtype> abstol_values;
+
+  N_Vector y;
+  N_Vector yout;
+  N_Vector abstol;
+
+  SUNMatrix Amat;
+  SUNLinearSolver Linsol;
+  void* cvode_mem;
+
+  CVodeWorkspace(const ReactIndices& ri, const int n_cells, const int lin_solver)
+    : num_cells(n_cells),
+      num_eqs_per_cell(ri.neqs),
+      size_flat(ri.neqs * n_cells),
+      linear_solver(lin_solver),
+      state_y(ri.neqs * n_cells, 0.0),
+      abstol_values(ri.neqs * n_cells, 1.0)
+  {
+    int flag;
+
+    user_data = new CVodeUserData(size_flat, num_cells, num_eqs_per_cell,
+				  ri.size_rpar_per_cell, 0,
+				  ri.nspec_not_evolved);
+
+    // Create NVectors
+    y = N_VNew_Serial(size_flat);
+    yout = N_VNew_Serial(size_flat);
+    abstol = N_VNew_Serial(size_flat);
+
+    // Set up CVODE with a placeholder state, the real initial
+    // conditions and tolerances are supplied by reinit()
+    set_nvector_serial(y, state_y.data(), size_flat);
+    set_nvector_serial(abstol, abstol_values.data(), size_flat);
+
+    cvode_mem = CVodeCreate(CV_BDF);
+    flag = CVodeSetUserData(cvode_mem, static_cast<void*>(user_data));
+    if (flag != CV_SUCCESS) amrex::Abort("Failed to set user data");
+    flag = CVodeInit(cvode_mem, fun_rhs, 0.0e0, y);
+    if (flag != CV_SUCCESS) amrex::Abort("Failed to initialize CVode");
+    flag = CVodeSVtolerances(cvode_mem, reltol, abstol);
+    if (flag != CV_SUCCESS) amrex::Abort("Failed to set tolerances");
+    flag = CVodeSetMaxNumSteps(cvode_mem, 150000);
+    if (flag != CV_SUCCESS) amrex::Abort("Failed to set max steps");
+
+    // Initialize Linear Solver
+    //
+    // The zones never couple, so the block-diagonal solver only stores
+    // and factors one neqs x neqs block per zone, while the dense solver
+    // works on the full (neqs*nzones)^2 matrix.
+    if (linear_solver == CVODE_LINSOLVE_BLOCK_DIAG) {
+      Amat = SUNBlockDiagMatrix(num_eqs_per_cell, num_cells);
+      Linsol = SUNBlockDiagLinearSolver(y, Amat);
+    } else {
+      Amat = SUNDenseMatrix(size_flat, size_flat);
+      Linsol = SUNDenseLinearSolver(y, Amat);
+    }
+    if (Amat == NULL || Linsol == NULL) amrex::Abort("Failed to create linear solver");
+    flag = CVDlsSetLinearSolver(cvode_mem, Linsol, Amat);
+    if (flag != CV_SUCCESS) amrex::Abort("Failed to set linear solver");
+    if (linear_solver == CVODE_LINSOLVE_BLOCK_DIAG) {
+      flag = CVDlsSetJacFn(cvode_mem, fun_jac_block_diag);
+    } else {
+      flag = CVDlsSetJacFn(cvode_mem, fun_jac);
+    }
+    if (flag != CV_SUCCESS) amrex::Abort("Failed to set jac function");
+  }
 
-  realtype reltol=1.0e-6, time=0.0e0, tout;
+  ~CVodeWorkspace()
+  {
+    N_VDestroy(y);
+    N_VDestroy(yout);
+    N_VDestroy(abstol);
+    CVodeFree(&cvode_mem);
+    SUNMatDestroy(Amat);
+    SUNLinSolFree(Linsol);
+    delete user_data;
+  }
 
-  realtype abstol_values[size_flat];
-  amrex::Real* state_y;
-  state_y = static_cast<amrex::Real*>(std::malloc(size_flat * sizeof(amrex::Real)));
+  CVodeWorkspace(const CVodeWorkspace&) = delete;
+  CVodeWorkspace& operator=(const CVodeWorkspace&) = delete;
 
-  N_Vector y = NULL, yout=NULL;
-  N_Vector abstol = NULL;
-  SUNMatrix Amat = NULL;
-  SUNLinearSolver Linsol = NULL;
-  void* cvode_mem = NULL;
-  int flag;
+  // Restart the integrator at time 0 from state_y with abstol_values.
+  // This also resets the CVODE statistics.
+  void reinit()
+  {
+    int flag;
+
+    set_nvector_serial(y, state_y.data(), size_flat);
+    set_nvector_serial(abstol, abstol_values.data(), size_flat);
+
+    flag = CVodeReInit(cvode_mem, 0.0e0, y);
+    if (flag != CV_SUCCESS) amrex::Abort("Failed to reinitialize CVode");
+    flag = CVodeSVtolerances(cvode_mem, reltol, abstol);
+    if (flag != CV_SUCCESS) amrex::Abort("Failed to set tolerances");
+  }
+};
+
+
+// Return this thread's workspace for a system of num_cells zones,
+// creating it the first time that shape is requested.
+static CVodeWorkspace& get_cvode_workspace(const ReactIndices& ri, const int num_cells,
+					   const int linear_solver)
+{
+  typedef std::tuple<int, int, int> WorkspaceKey;
+  static thread_local std::map<WorkspaceKey, std::unique_ptr<CVodeWorkspace>> pool;
+
+  const WorkspaceKey key(ri.neqs, num_cells, linear_solver);
+
+  auto it = pool.find(key);
+  if (it == pool.end()) {
+    it = pool.emplace(key, std::unique_ptr<CVodeWorkspace>(new CVodeWorkspace(ri, num_cells, linear_solver))).first;
+  }
+
+  CVodeWorkspace& ws = *(it->second);
+  ws.user_data->zero_rpar_data();
+
+  return ws;
+}
+
+
+void do_react(const int* lo, const int* hi,
+	      amrex::Real* state, const int* s_lo, const int* s_hi,
+	      const int ncomp, const amrex::Real dt, const int linear_solver,
+	      long* n_rhs, long* n_jac, long* n_linsetup, long* n_steps)
+{
+  const int size_x = hi[0]-lo[0]+1;
+  const int size_y = hi[1]-lo[1]+1;
+  const int size_z = hi[2]-lo[2]+1;
+  const int size_state = size_x * size_y * size_z;
+
+  ReactIndices ri;
+  ri.fill();
 
-  // Create NVectors
-  y = N_VNew_Serial(size_flat);
-  yout = N_VNew_Serial(size_flat);
-  abstol = N_VNew_Serial(size_flat);
+  CVodeWorkspace& ws = get_cvode_workspace(ri, size_state, linear_solver);
+
+  realtype time=0.0e0, tout;
+  int flag;
 
   // Initialize y, abstol from flattened state
   int nzone = 0;
   for (int i=lo[0]; i<=hi[0]; i++) {
     for (int j=lo[1]; j<=hi[1]; j++) {
       for (int k=lo[2]; k<=hi[2]; k++) {
-	// Put mass fractions into integration vector
-	int scomp = 0;
-        for (int n=idx_spec_old; n<idx_spec_old+nspec_evolve; n++) {
-          get_state(state, s_lo, s_hi, ncomp, i, j, k, n, &state_y[nzone*neqs + scomp]);
-	  abstol_values[nzone*neqs + scomp] = 1.0e-12;
-	  scomp++;
-        }
-
-	// Temperature absolute tolerance
-	abstol_values[nzone*neqs + nspec_evolve] = 1.0e-6;
-
-	// Energy absolute tolerance
-	abstol_values[nzone*neqs + nspec_evolve + 1] = 1.0e-6;
-	
-	// Put temperature into integration vector
-	get_state(state, s_lo, s_hi, ncomp, i, j, k, idx_temp,
-		  &state_y[nzone*neqs + nspec_evolve]);
-
-	// Initialize energy to 0, we'll get it from the EOS
-	state_y[nzone*neqs + nspec_evolve + 1] = 0.0e0;
-
-	// Put density in user data
-	get_state(state, s_lo, s_hi, ncomp, i, j, k, idx_dens,
-		  &user_data->rpar[nzone*user_data->num_rpar_per_cell + user_data->irp_dens]);
-
-	// Put unevolved mass fractions in user data
-	scomp=0;
-	for (int n=idx_spec_old+nspec_evolve; n<idx_spec_old+nspec_evolve+nspec_not_evolved; n++) {
-	  get_state(state, s_lo, s_hi, ncomp, i, j, k, n,
-		    &user_data->rpar[nzone*user_data->num_rpar_per_cell + user_data->irp_xn_not_evolved + scomp]);
-	  scomp++;
-	}
-
-	// Set zone size dx in rpar(irp_dx)
-	user_data->rpar[nzone*user_data->num_rpar_per_cell + user_data->irp_dx] = 1.0;
-
-	// Set time offset to the simulation time of 0
-	user_data->rpar[nzone*user_data->num_rpar_per_cell + user_data->irp_t0] = 0.0;
-
+	load_zone(ri, state, s_lo, s_hi, ncomp, i, j, k, nzone,
+		  ws.state_y.data(), ws.abstol_values.data(), ws.user_data);
 	nzone++;
       }
     }
   }
 
   // Prepare cell data for integration (X->Y, normalization, call EOS)
-  initialize_system(&state_y[0], user_data);
-  
+  initialize_system(ws.state_y.data(), ws.user_data);
+
   // Set CVODE initial values and absolute tolerances
-  set_nvector_serial(y, &state_y[0], size_flat);
-  set_nvector_serial(abstol, &abstol_values[0], size_flat);
-
-  // Initialize CVODE
-  cvode_mem = CVodeCreate(CV_BDF);
-  flag = CVodeSetUserData(cvode_mem, static_cast<void*>(user_data));
-  if (flag != CV_SUCCESS) amrex::Abort("Failed to set user data");
-  flag = CVodeInit(cvode_mem, fun_rhs, time, y);
-  if (flag != CV_SUCCESS) amrex::Abort("Failed to initialize CVode");  
-  flag = CVodeSVtolerances(cvode_mem, reltol, abstol);
-  if (flag != CV_SUCCESS) amrex::Abort("Failed to set tolerances");  
-  flag = CVodeSetMaxNumSteps(cvode_mem, 150000);
-  if (flag != CV_SUCCESS) amrex::Abort("Failed to set max steps");  
-
-  // Initialize Linear Solver
-  Amat = SUNDenseMatrix(size_flat, size_flat);
-  Linsol = SUNDenseLinearSolver(y, Amat);
-  flag = CVDlsSetLinearSolver(cvode_mem, Linsol, Amat);
-  if (flag != CV_SUCCESS) amrex::Abort("Failed to set linear solver");  
-  flag = CVDlsSetJacFn(cvode_mem, fun_jac);
-  if (flag != CV_SUCCESS) amrex::Abort("Failed to set jac function");
+  ws.reinit();
 
   // Do Integration
   time = time + static_cast<realtype>(dt);
-  flag = CVode(cvode_mem, time, yout, &tout, CV_NORMAL);
+  flag = CVode(ws.cvode_mem, time, ws.yout, &tout, CV_NORMAL);
   if (flag != CV_SUCCESS) amrex::Abort("Failed integration");
 
-  flag = CVodeGetNumRhsEvals(cvode_mem, n_rhs);
-  flag = CVDlsGetNumJacEvals(cvode_mem, n_jac);
-  flag = CVodeGetNumLinSolvSetups(cvode_mem, n_linsetup);
+  flag = CVodeGetNumRhsEvals(ws.cvode_mem, n_rhs);
+  flag = CVDlsGetNumJacEvals(ws.cvode_mem, n_jac);
+  flag = CVodeGetNumLinSolvSetups(ws.cvode_mem, n_linsetup);
+  flag = CVodeGetNumSteps(ws.cvode_mem, n_steps);
 
   // Get Final State
-  get_nvector_serial(yout, &state_y[0], size_flat);
+  get_nvector_serial(ws.yout, ws.state_y.data(), ws.size_flat);
 
   // Finalize cell data to save
-  finalize_system(&state_y[0], user_data);
+  finalize_system(ws.state_y.data(), ws.user_data);
 
   // Save Final State
   nzone = 0;
   for (int i=lo[0]; i<=hi[0]; i++) {
     for (int j=lo[1]; j<=hi[1]; j++) {
       for (int k=lo[2]; k<=hi[2]; k++) {
-	// Put evolved mass fractions into state
-	int scomp = 0;
-        for (int n=idx_spec; n<idx_spec+nspec_evolve; n++) {
-          set_state(state, s_lo, s_hi, ncomp, i, j, k, n, state_y[nzone*neqs + scomp]);
-	  scomp++;
-        }
-
-	// Put unevolved mass fractions into state
-	scomp=0;
-	for (int n=idx_spec+nspec_evolve; n<idx_spec+nspec_evolve+nspec_not_evolved; n++) {
-	  set_state(state, s_lo, s_hi, ncomp, i, j, k, n,
-		    user_data->rpar[nzone*user_data->num_rpar_per_cell + user_data->irp_xn_not_evolved + scomp]);
-	  scomp++;
-	}
-
-	// Put omegadot into state
-	amrex::Real xn_start, xn_final, wscratch;
-	scomp = 0;
-	int n_spec_old;
-        for (int n=idx_omegadot; n<idx_omegadot+nspec_evolve+nspec_not_evolved; n++) {
-	  n_spec_old = n-idx_omegadot+idx_spec_old;
-          get_state(state, s_lo, s_hi, ncomp, i, j, k, n_spec_old, &xn_start);
-	  if (scomp < nspec_evolve) {
-	    xn_final = state_y[nzone*neqs + scomp];
-	  } else {
-	    xn_final = user_data->rpar[nzone*user_data->num_rpar_per_cell + user_data->irp_xn_not_evolved + scomp - nspec_evolve];
-	  }
-	  wscratch = (xn_final - xn_start)/dt;
-	  set_state(state, s_lo, s_hi, ncomp, i, j, k, n, wscratch);
-	  scomp++;
-        }
-
-	// Set rho*Hnuc
-	get_state(state, s_lo, s_hi, ncomp, i, j, k, idx_dens, &wscratch);
-	wscratch = wscratch * state_y[nzone*neqs + nspec_evolve + 1]/dt;
-	set_state(state, s_lo, s_hi, ncomp, i, j, k, idx_dens_hnuc, wscratch);
-
+	store_zone(ri, state, s_lo, s_hi, ncomp, i, j, k, nzone,
+		   ws.state_y.data(), ws.user_data, dt);
 	nzone++;
       }
     }
   }
+}
+
+
+void do_react_per_zone(const int* lo, const int* hi,
+		       amrex::Real* state, const int* s_lo, const int* s_hi,
+		       const int ncomp, const amrex::Real dt,
+		       ReactStats& stats)
+{
+  // Integrate every zone as its own CVODE system, so each zone has its
+  // own step size and order history and a stiff zone does not force
+  // the quiescent zones in the box through tiny steps.  Zones are
+  // handed out to threads dynamically, since their cost varies by
+  // orders of magnitude.
+
+  const int size_x = hi[0]-lo[0]+1;
+  const int size_y = hi[1]-lo[1]+1;
+  const int size_z = hi[2]-lo[2]+1;
+  const int size_state = size_x * size_y * size_z;
+
+  ReactIndices ri;
+  ri.fill();
+
+  const int neqs = ri.neqs;
+
+  // per-zone statistics, indexed by zone
+  std::vector<long> zone_rhs(size_state, 0);
+  std::vector<long> zone_steps(size_state, 0);
+  std::vector<long> zone_jac(size_state, 0);
+  std::vector<long> zone_linsetup(size_state, 0);
+
+  // the wall time of each thread over this box
+  std::vector<Real> thread_times;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+  {
+    // Each thread reuses one single-zone CVODE system from its
+    // workspace pool for all of the zones it integrates.
+    CVodeWorkspace& ws = get_cvode_workspace(ri, 1, CVODE_LINSOLVE_DENSE);
+
+    realtype time, tout;
+    int flag;
+
+    Real thread_strt_time = ParallelDescriptor::second();
+
+    // nowait, so that the time of each thread is read when it runs
+    // out of zones rather than after the barrier at the end of the loop
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1) nowait
+#endif
+    for (int nzone = 0; nzone < size_state; nzone++) {
+
+      // zones are ordered the same way as in do_react (k fastest)
+      const int k = lo[2] + nzone % size_z;
+      const int j = lo[1] + (nzone / size_z) % size_y;
+      const int i = lo[0] + nzone / (size_z * size_y);
+
+      ws.user_data->zero_rpar_data();
+
+      load_zone(ri, state, s_lo, s_hi, ncomp, i, j, k, 0,
+		ws.state_y.data(), ws.abstol_values.data(), ws.user_data);
+
+      // Prepare cell data for integration (X->Y, normalization, call EOS)
+      initialize_system(ws.state_y.data(), ws.user_data);
+
+      // this also resets the integrator statistics, so the counts
+      // below are for this zone alone
+      ws.reinit();
+
+      time = static_cast<realtype>(dt);
+      flag = CVode(ws.cvode_mem, time, ws.yout, &tout, CV_NORMAL);
+      if (flag != CV_SUCCESS) amrex::Abort("Failed integration");
+
+      CVodeGetNumRhsEvals(ws.cvode_mem, &zone_rhs[nzone]);
+      CVodeGetNumSteps(ws.cvode_mem, &zone_steps[nzone]);
+      CVDlsGetNumJacEvals(ws.cvode_mem, &zone_jac[nzone]);
+      CVodeGetNumLinSolvSetups(ws.cvode_mem, &zone_linsetup[nzone]);
+
+      get_nvector_serial(ws.yout, ws.state_y.data(), neqs);
+
+      finalize_system(ws.state_y.data(), ws.user_data);
+
+      store_zone(ri, state, s_lo, s_hi, ncomp, i, j, k, 0,
+		 ws.state_y.data(), ws.user_data, dt);
+    }
+
+    Real thread_time = ParallelDescriptor::second() - thread_strt_time;
+
+#ifdef _OPENMP
+#pragma omp critical (react_stats_merge)
+#endif
+    thread_times.push_back(thread_time);
+  }
 
-  // Free Memory
-  N_VDestroy(y);
-  N_VDestroy(yout);
-  N_VDestroy(abstol);
-  CVodeFree(&cvode_mem);
-  SUNMatDestroy(Amat);
-  SUNLinSolFree(Linsol);
-  user_data->~CVodeUserData();  
-  std::free(user_data);
-  std::free(state_y);
+  if (thread_times.size() > 0) {
+    Real thread_time_max = 0.0;
+    Real thread_time_sum = 0.0;
+    for (const Real thread_time : thread_times) {
+      thread_time_max = std::max(thread_time_max, thread_time);
+      thread_time_sum += thread_time;
+    }
+
+    const Real thread_time_avg = thread_time_sum / thread_times.size();
+    if (thread_time_avg > 0.0) {
+      stats.add_thread_imbalance(thread_time_max / thread_time_avg);
+    }
+  }
 
+  // The box-level counts are the sums over its zones, the per-zone
+  // counts show the spread in cost between zones.
+  long n_rhs = 0;
+  long n_jac = 0;
+  long n_linsetup = 0;
+  for (int nzone = 0; nzone < size_state; nzone++) {
+    n_rhs += zone_rhs[nzone];
+    n_jac += zone_jac[nzone];
+    n_linsetup += zone_linsetup[nzone];
+    stats.add_zone(zone_steps[nzone], zone_rhs[nzone]);
+  }
+  stats.add_box(n_rhs, n_jac, n_linsetup);
 }
 
 
@@ -272,18 +525,26 @@ static void get_nvector_serial(N_Vector vec, realtype* data, sunindextype size)
 }
 
 
+// The Fortran cell routines may clean up the state they are given, so
+// they get a copy of CVODE's y.  The copy lives in a per-thread buffer
+// so we don't allocate on every RHS or Jacobian evaluation.
+static realtype* get_state_scratch(N_Vector y, const int size)
+{
+  static thread_local std::vector<realtype> scratch;
+  scratch.resize(size);
+  get_nvector_serial(y, scratch.data(), size);
+  return scratch.data();
+}
+
+
 static int fun_rhs(realtype t, N_Vector y, N_Vector ydot, void *user_data)
 {
   CVodeUserData* udata = static_cast<CVodeUserData*>(user_data);
-  amrex::Real* state_y = static_cast<amrex::Real*>(std::malloc(udata->num_cells * udata->num_eqs_per_cell * sizeof(amrex::Real)));
-  amrex::Real* state_ydot = static_cast<amrex::Real*>(std::malloc(udata->num_cells * udata->num_eqs_per_cell * sizeof(amrex::Real)));
-  get_nvector_serial(y, state_y, udata->num_cells * udata->num_eqs_per_cell);
+  realtype* state_y = get_state_scratch(y, udata->num_cells * udata->num_eqs_per_cell);
+  realtype* state_ydot = N_VGetArrayPointer(ydot);
   for (int i=0; i<udata->num_cells; i++) {
     fun_rhs_kernel(t, state_y, state_ydot, user_data, i);
   }
-  set_nvector_serial(ydot, state_ydot, udata->num_cells * udata->num_eqs_per_cell);
-  std::free(state_y);
-  std::free(state_ydot);
   return 0;
 }
 
@@ -304,16 +565,32 @@ static int fun_jac(realtype tn, N_Vector y, N_Vector fy, SUNMatrix J,
 {
   CVodeUserData* udata = static_cast<CVodeUserData*>(user_data);  
   realtype* Jdata;
-  amrex::Real* state_y = static_cast<amrex::Real*>(std::malloc(udata->num_cells * udata->num_eqs_per_cell * sizeof(amrex::Real)));
-  get_nvector_serial(y, state_y, udata->num_cells * udata->num_eqs_per_cell);
+  realtype* state_y = get_state_scratch(y, udata->num_cells * udata->num_eqs_per_cell);
   Jdata = SUNDenseMatrix_Data(J);
 
   sk_full_jac(state_y, Jdata, udata->rpar,
 	      &udata->num_eqs, &udata->num_cells,
 	      &udata->num_eqs_per_cell, &udata->num_rpar_per_cell);
 
-  std::free(state_y);
-
   return 0;
 }
 
+
+static int fun_jac_block_diag(realtype tn, N_Vector y, N_Vector fy, SUNMatrix J,
+                              void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+  // Each zone's Jacobian goes directly into its own block of J,
+  // so we never form the (mostly zero) full matrix.
+  CVodeUserData* udata = static_cast<CVodeUserData*>(user_data);
+  realtype* ydata = get_state_scratch(y, udata->num_cells * udata->num_eqs_per_cell);
+  realtype t = tn;
+
+  for (int i=0; i<udata->num_cells; i++) {
+    int offset = i * udata->num_eqs_per_cell;
+    int rpar_offset = i * udata->num_rpar_per_cell;
+    sk_analytic_jac(&t, &ydata[offset], SUNBlockDiagMatrix_Block(J, i),
+		    &udata->rpar[rpar_offset]);
+  }
+
+  return 0;
+}
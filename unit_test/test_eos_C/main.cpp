@@ -19,6 +19,250 @@ using namespace amrex;
 
 #include <cmath>
 
+#ifdef EOS_HELMHOLTZ
+#include <actual_eos_warm_start.H>
+
+// Time zone-by-zone eos_input_rt calls over the grid with the
+// default (separate) Helmholtz table layout and with the interleaved
+// per-cell layout, and check that both give the same answer.
+void table_layout_benchmark(const MultiFab& state, const plot_t& vars, const int nrep)
+{
+    Vector<eos_t> zones;
+
+    for ( MFIter mfi(state); mfi.isValid(); ++mfi )
+    {
+        const Box& bx = mfi.validbox();
+        auto const sp = state.const_array(mfi);
+
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+        {
+            eos_t eos_state;
+            eos_state.rho = sp(i, j, k, vars.irho);
+            eos_state.T = sp(i, j, k, vars.itemp);
+            eos_state.abar = sp(i, j, k, vars.iabar);
+            eos_state.zbar = sp(i, j, k, vars.izbar);
+            eos_state.y_e = eos_state.zbar / eos_state.abar;
+            eos_state.mu_e = 1.0 / eos_state.y_e;
+            zones.push_back(eos_state);
+        });
+    }
+
+    const int npts = zones.size();
+
+    const bool interleaved_in = helmholtz::use_interleaved_table;
+
+    // the interleaved table is only built at init if it was requested
+    build_interleaved_table();
+
+    Vector<Real> layout_time(2);
+    Vector<Real> p_out[2], e_out[2];
+
+    for (int layout = 0; layout < 2; layout++) {
+
+        helmholtz::use_interleaved_table = (layout == 1);
+
+        p_out[layout].resize(npts);
+        e_out[layout].resize(npts);
+
+        Real strt_time = ParallelDescriptor::second();
+
+        for (int r = 0; r < nrep; r++) {
+            for (int n = 0; n < npts; n++) {
+                eos_t eos_state = zones[n];
+
+                actual_eos(eos_input_rt, eos_state);
+
+                p_out[layout][n] = eos_state.p;
+                e_out[layout][n] = eos_state.e;
+            }
+        }
+
+        layout_time[layout] = ParallelDescriptor::second() - strt_time;
+    }
+
+    helmholtz::use_interleaved_table = interleaved_in;
+
+    Real max_err_p = 0.0;
+    Real max_err_e = 0.0;
+    for (int n = 0; n < npts; n++) {
+        max_err_p = amrex::max(max_err_p, std::abs(p_out[1][n] - p_out[0][n]) / std::abs(p_out[0][n]));
+        max_err_e = amrex::max(max_err_e, std::abs(e_out[1][n] - e_out[0][n]) / std::abs(e_out[0][n]));
+    }
+
+    amrex::Print() << "EOS table layout benchmark: " << npts << " zones x " << nrep << " repetitions" << std::endl;
+    amrex::Print() << "  separate tables time   = " << layout_time[0] << std::endl;
+    amrex::Print() << "  interleaved table time = " << layout_time[1] << std::endl;
+    amrex::Print() << "  speedup                = " << layout_time[0] / layout_time[1] << std::endl;
+    amrex::Print() << "  max rel. difference in p = " << max_err_p << std::endl;
+    amrex::Print() << "  max rel. difference in e = " << max_err_e << std::endl;
+}
+
+// Compare eos_input_re inversions over the grid with and without the
+// precomputed inverse table: the time taken, the accuracy of the
+// tabulated T alone, and the accuracy of the final T, relative to the
+// usual Newton iteration.
+void inverse_table_benchmark(const MultiFab& state, const plot_t& vars, const int nrep)
+{
+    Vector<eos_t> zones;
+
+    for ( MFIter mfi(state); mfi.isValid(); ++mfi )
+    {
+        const Box& bx = mfi.validbox();
+        auto const sp = state.const_array(mfi);
+
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+        {
+            eos_t eos_state;
+            eos_state.rho = sp(i, j, k, vars.irho);
+            eos_state.T = sp(i, j, k, vars.itemp);
+            eos_state.e = sp(i, j, k, vars.ie);
+            eos_state.abar = sp(i, j, k, vars.iabar);
+            eos_state.zbar = sp(i, j, k, vars.izbar);
+            eos_state.y_e = eos_state.zbar / eos_state.abar;
+            eos_state.mu_e = 1.0 / eos_state.y_e;
+            zones.push_back(eos_state);
+        });
+    }
+
+    const int npts = zones.size();
+
+    const bool inverse_in = helmholtz::use_inverse_table;
+
+    // the inverse table is only built at init if it was requested
+    build_inverse_table();
+
+    // accuracy of the table by itself
+
+    int n_in_table = 0;
+    Real max_err_table = 0.0;
+
+    for (int n = 0; n < npts; n++) {
+        Real T_table;
+        if (inverse_table_lookup(zones[n].rho, zones[n].e, zones[n].abar, zones[n].y_e, T_table)) {
+            n_in_table++;
+            max_err_table = amrex::max(max_err_table, std::abs(T_table - zones[n].T) / zones[n].T);
+        }
+    }
+
+    Vector<Real> run_time(2);
+    Vector<Real> T_out[2];
+
+    for (int use_table = 0; use_table < 2; use_table++) {
+
+        helmholtz::use_inverse_table = (use_table == 1);
+
+        T_out[use_table].resize(npts);
+
+        Real strt_time = ParallelDescriptor::second();
+
+        for (int r = 0; r < nrep; r++) {
+            for (int n = 0; n < npts; n++) {
+                eos_t eos_state = zones[n];
+
+                // the same starting guess the grid sweep uses
+                eos_state.T = 100.0;
+
+                actual_eos(eos_input_re, eos_state);
+
+                T_out[use_table][n] = eos_state.T;
+            }
+        }
+
+        run_time[use_table] = ParallelDescriptor::second() - strt_time;
+    }
+
+    helmholtz::use_inverse_table = inverse_in;
+
+    Real max_err_newton = 0.0;
+    Real max_err_inverse = 0.0;
+    for (int n = 0; n < npts; n++) {
+        max_err_newton = amrex::max(max_err_newton, std::abs(T_out[0][n] - zones[n].T) / zones[n].T);
+        max_err_inverse = amrex::max(max_err_inverse, std::abs(T_out[1][n] - zones[n].T) / zones[n].T);
+    }
+
+    amrex::Print() << "EOS inverse table benchmark: " << npts << " zones x " << nrep << " repetitions" << std::endl;
+    amrex::Print() << "  zones inside the table    = " << n_in_table << std::endl;
+    amrex::Print() << "  max rel. T error, table alone      = " << max_err_table << std::endl;
+    amrex::Print() << "  max rel. T error, Newton           = " << max_err_newton << std::endl;
+    amrex::Print() << "  max rel. T error, table + Newton   = " << max_err_inverse << std::endl;
+    amrex::Print() << "  Newton time        = " << run_time[0] << std::endl;
+    amrex::Print() << "  inverse table time = " << run_time[1] << std::endl;
+    amrex::Print() << "  speedup            = " << run_time[0] / run_time[1] << std::endl;
+}
+
+// Count the Newton iterations that eos_input_re and eos_input_ps
+// inversions take over the grid when started cold (from a guess off
+// by a factor of 2) and warm (from a hint off by 0.1%, like the
+// previous hydro step would give), using actual_eos_warm_start.
+void warm_start_benchmark(const MultiFab& state, const plot_t& vars)
+{
+    const eos_input_t inputs[2] = {eos_input_re, eos_input_ps};
+    const std::string input_names[2] = {"re", "ps"};
+
+    for (int m = 0; m < 2; m++) {
+
+        long iters[2] = {0, 0};
+        int max_iters[2] = {0, 0};
+        long fallback[2] = {0, 0};
+        long failures[2] = {0, 0};
+        long npts = 0;
+
+        for ( MFIter mfi(state); mfi.isValid(); ++mfi )
+        {
+            const Box& bx = mfi.validbox();
+            auto const sp = state.const_array(mfi);
+
+            amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+            {
+                eos_t ref;
+                ref.rho = sp(i, j, k, vars.irho);
+                ref.T = sp(i, j, k, vars.itemp);
+                ref.abar = sp(i, j, k, vars.iabar);
+                ref.zbar = sp(i, j, k, vars.izbar);
+                ref.y_e = ref.zbar / ref.abar;
+                ref.mu_e = 1.0 / ref.y_e;
+
+                actual_eos(eos_input_rt, ref);
+
+                npts++;
+
+                for (int w = 0; w < 2; w++) {
+
+                    const Real fac = (w == 0) ? 2.0 : 1.001;
+
+                    eos_t eos_state = ref;
+                    eos_warm_start_t hint;
+
+                    hint.T = fac * ref.T;
+                    if (inputs[m] == eos_input_ps) {
+                        hint.rho = fac * ref.rho;
+                    }
+
+                    int n = actual_eos_warm_start(inputs[m], eos_state, hint);
+
+                    iters[w] += n;
+                    max_iters[w] = amrex::max(max_iters[w], n);
+                    fallback[w] += hint.fallback_steps;
+                    if (!hint.converged) {
+                        failures[w]++;
+                    }
+                }
+            });
+        }
+
+        amrex::Print() << "EOS warm start benchmark, eos_input_" << input_names[m]
+                       << ": " << npts << " zones" << std::endl;
+        for (int w = 0; w < 2; w++) {
+            amrex::Print() << ((w == 0) ? "  cold: " : "  warm: ")
+                           << "mean iterations = " << static_cast<Real>(iters[w]) / npts
+                           << ", max iterations = " << max_iters[w]
+                           << ", fallback steps = " << fallback[w]
+                           << ", unconverged = " << failures[w] << std::endl;
+        }
+    }
+}
+#endif
+
 int main (int argc, char* argv[])
 {
     amrex::Initialize(argc, argv);
@@ -34,6 +278,10 @@ void main_main ()
 
     // AMREX_SPACEDIM: number of dimensions
     int n_cell, max_grid_size;
+    int batch_benchmark_nrep = 10;
+    int do_table_layout_benchmark = 0;
+    int do_warm_start_benchmark = 0;
+    int do_inverse_table_benchmark = 0;
     Vector<int> bc_lo(AMREX_SPACEDIM,0);
     Vector<int> bc_hi(AMREX_SPACEDIM,0);
 
@@ -50,6 +298,21 @@ void main_main ()
         max_grid_size = 32;
         pp.query("max_grid_size", max_grid_size);
 
+        // The number of times each timed benchmark below is repeated
+        pp.query("batch_benchmark_nrep", batch_benchmark_nrep);
+
+        // Optionally compare the interleaved Helmholtz table layout
+        // against the separate tables (helmholtz only)
+        pp.query("do_table_layout_benchmark", do_table_layout_benchmark);
+
+        // Optionally report the iteration counts of cold and
+        // warm-started Helmholtz inversions (helmholtz only)
+        pp.query("do_warm_start_benchmark", do_warm_start_benchmark);
+
+        // Optionally compare eos_input_re with and without the
+        // Helmholtz inverse table (helmholtz only)
+        pp.query("do_inverse_table_benchmark", do_inverse_table_benchmark);
+
     }
 
     Vector<int> is_periodic(AMREX_SPACEDIM,0);
@@ -354,4 +617,18 @@ void main_main ()
     // Tell the I/O Processor to write out the "run time"
     amrex::Print() << "Run time = " << stop_time << std::endl;
 
+#ifdef EOS_HELMHOLTZ
+    if (do_table_layout_benchmark) {
+        table_layout_benchmark(state, vars, batch_benchmark_nrep);
+    }
+
+    if (do_warm_start_benchmark) {
+        warm_start_benchmark(state, vars);
+    }
+
+    if (do_inverse_table_benchmark) {
+        inverse_table_benchmark(state, vars, batch_benchmark_nrep);
+    }
+#endif
+
 }
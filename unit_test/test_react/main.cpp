@@ -14,6 +14,9 @@ using namespace amrex;
 #include "test_react_F.H"
 #include "AMReX_buildInfo.H"
 
+#include <burner_cost.H>
+#include <burner_F.H>
+
 
 int main (int argc, char* argv[])
 {
@@ -30,6 +33,7 @@ void main_main ()
 
     // AMREX_SPACEDIM: number of dimensions
     int n_cell, max_grid_size, print_every_nrhs;
+    int do_jacobian_cache_test;
     Vector<int> bc_lo(AMREX_SPACEDIM,0);
     Vector<int> bc_hi(AMREX_SPACEDIM,0);
 
@@ -55,6 +59,11 @@ void main_main ()
 
         pp.query("prefix", prefix);
 
+        // burn the initial state a second time, with the Jacobians
+        // cached by the first burn, and compare
+        do_jacobian_cache_test = 0;
+        pp.query("do_jacobian_cache_test", do_jacobian_cache_test);
+
     }
 
     Vector<int> is_periodic(AMREX_SPACEDIM,0);
@@ -149,6 +158,21 @@ void main_main ()
     // so we can manually do the reductions (for GPU)
     iMultiFab integrator_n_rhs(ba, dm, 1, Nghost);
 
+#ifdef NSE_TABLE
+    nse_table_clear_stats();
+#endif
+
+#if (INTEGRATOR == 0 || INTEGRATOR == 1) && !defined(CUDA)
+    vode_jacobian_cache_clear();
+
+    // keep the initial state for the second burn
+    MultiFab state_init;
+    if (do_jacobian_cache_test) {
+        state_init.define(ba, dm, Ncomp, Nghost);
+        MultiFab::Copy(state_init, state, 0, 0, Ncomp, Nghost);
+    }
+#endif
+
     // What time is it now?  We'll use this to compute total react time.
     Real strt_time = ParallelDescriptor::second();
 
@@ -160,11 +184,29 @@ void main_main ()
     {
         const Box& bx = mfi.tilebox();
 
+#ifndef AMREX_USE_GPU
+        burner_clear_zone_stats();
+#endif
+
 #pragma gpu
         do_react(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
                  BL_TO_FORTRAN_ANYD(state[mfi]),
 		 BL_TO_FORTRAN_ANYD(integrator_n_rhs[mfi]));
 
+#ifndef AMREX_USE_GPU
+        // the zones of this box that burner skipped (see
+        // burner_skip_tol) and integrated
+        int n_skipped = 0;
+        int n_integrated = 0;
+        burner_zone_stats(&n_skipped, &n_integrated);
+
+#ifdef _OPENMP
+#pragma omp critical (test_react_box_stats)
+#endif
+        amrex::AllPrint() << "box " << bx << ": zones skipped = " << n_skipped
+                          << ", integrated = " << n_integrated << std::endl;
+#endif
+
 	if (print_every_nrhs != 0)
 	  print_nrhs(AMREX_ARLIM_ANYD(bx.loVect()), AMREX_ARLIM_ANYD(bx.hiVect()),
 		     BL_TO_FORTRAN_ANYD(integrator_n_rhs[mfi]));
@@ -180,6 +222,12 @@ void main_main ()
     int n_rhs_max = integrator_n_rhs.max(0);
     long n_rhs_sum = integrator_n_rhs.sum(0, 0, true);
 
+    // the balance of the burn over the ranks, with the boxes as they
+    // are and as they would be distributed on the RHS evaluations
+    Vector<Real> box_costs = burner_box_costs(integrator_n_rhs);
+    Real balance = burner_rank_balance(box_costs, dm);
+    Real balance_knapsack = burner_rank_balance(box_costs, burner_distribution(ba, box_costs));
+
     // get the name of the integrator from the build info functions
     // written at compile time.  We will append the name of the
     // integrator to the output file name
@@ -209,4 +257,70 @@ void main_main ()
     std::cout << "avg number of rhs calls: " << n_rhs_sum / (n_cell*n_cell*n_cell) << std::endl;
     std::cout << "max number of rhs calls: " << n_rhs_max << std::endl;
 
+    amrex::Print() << "load balance of the burn: " << balance
+                   << " (knapsack on the rhs calls: " << balance_knapsack << ")" << std::endl;
+
+#ifdef NSE_TABLE
+    // the zones taken from the NSE table, and the integrator time saved
+    nse_table_report();
+#endif
+
+#if (INTEGRATOR == 0 || INTEGRATOR == 1) && !defined(CUDA)
+    // the lookups of the VODE Jacobian cache (see jacobian_cache_size)
+    int n_hits = 0;
+    int n_stale = 0;
+    int n_misses = 0;
+    vode_jacobian_cache_stats(&n_hits, &n_stale, &n_misses);
+    amrex::Print() << "Jacobian cache: hits = " << n_hits << ", stale = " << n_stale
+                   << ", misses = " << n_misses << std::endl;
+
+    if (do_jacobian_cache_test) {
+
+        // Burn the initial state again.  The zones that have not moved
+        // far from where their last Jacobian was evaluated start from
+        // it, and should reach the same state to within the
+        // integration tolerances.  The statistics count from the
+        // first burn, so we take the difference.
+
+        int n_hits_first = n_hits;
+        int n_stale_first = n_stale;
+        int n_misses_first = n_misses;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for ( MFIter mfi(state_init, tile_size); mfi.isValid(); ++mfi )
+        {
+            const Box& bx = mfi.tilebox();
+
+            do_react(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+                     BL_TO_FORTRAN_ANYD(state_init[mfi]),
+                     BL_TO_FORTRAN_ANYD(integrator_n_rhs[mfi]));
+        }
+
+        vode_jacobian_cache_stats(&n_hits, &n_stale, &n_misses);
+        n_hits -= n_hits_first;
+        n_stale -= n_stale_first;
+        n_misses -= n_misses_first;
+        amrex::Print() << "Jacobian cache, second burn: hits = " << n_hits << ", stale = " << n_stale
+                       << ", misses = " << n_misses << std::endl;
+
+        // the largest difference between the two burns, relative to
+        // the largest value of each component
+        Real max_rel_diff = 0.0;
+        for (int n = 0; n < Ncomp; ++n) {
+            Real scale = state.norm0(n);
+            MultiFab::Subtract(state_init, state, n, n, 1, Nghost);
+            if (scale > 0.0) {
+                max_rel_diff = std::max(max_rel_diff, state_init.norm0(n) / scale);
+            }
+        }
+        amrex::Print() << "max relative difference from the first burn = " << max_rel_diff << std::endl;
+
+        if (n_hits == 0) {
+            amrex::Error("the second burn found none of the Jacobians cached by the first");
+        }
+    }
+#endif
+
 }
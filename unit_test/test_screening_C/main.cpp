@@ -21,6 +21,127 @@ using namespace amrex;
 #include <variables.H>
 
 #include <cmath>
+#include <string>
+
+// Whether every screening factor of a zone is in the weak screening
+// regime, where screen5_batch takes the screen5_weak shortcut.
+bool weak_screening_zone(const plasma_state_t& state)
+{
+    for (int jscr = 0; jscr < NSCREEN; jscr++) {
+        Real bb = scn_facs[jscr].z1 * scn_facs[jscr].z2;
+        Real gamef = fact * bb * scn_facs[jscr].zs13inv * state.aa;
+
+        // screen5 limits gamef (through alph12) to 1.6 tau12
+        gamef = amrex::min(gamef, 1.6e0_rt * state.taufac * scn_facs[jscr].aznut);
+
+        if (gamef > gamefx) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Time screen5, one factor at a time, against screen5_batch, all of
+// the factors of a zone in one loop, over the zones in pstate and
+// compare the two.
+void screen_benchmark_zones(const Vector<plasma_state_t>& pstate, const int nrep,
+                            const std::string& regime)
+{
+    const int npts = pstate.size();
+
+    amrex::Print() << "  " << regime << " screening zones: " << npts << std::endl;
+
+    if (npts == 0) {
+        return;
+    }
+
+    Vector<Real> scor(NSCREEN * npts, 0.0);
+    Vector<Real> scordt(NSCREEN * npts, 0.0);
+    Vector<Real> scor_batch(NSCREEN * npts, 0.0);
+    Vector<Real> scordt_batch(NSCREEN * npts, 0.0);
+
+    Real strt_time = ParallelDescriptor::second();
+
+    for (int r = 0; r < nrep; r++) {
+        for (int n = 0; n < npts; n++) {
+            for (int jscr = 0; jscr < NSCREEN; jscr++) {
+                Real scordd;
+                screen5(pstate[n], jscr, scor[n*NSCREEN + jscr],
+                        scordt[n*NSCREEN + jscr], scordd);
+            }
+        }
+    }
+
+    Real pair_time = ParallelDescriptor::second() - strt_time;
+
+    strt_time = ParallelDescriptor::second();
+
+    for (int r = 0; r < nrep; r++) {
+        screen5_batch(npts, pstate.dataPtr(), scor_batch.dataPtr(), scordt_batch.dataPtr());
+    }
+
+    Real batch_time = ParallelDescriptor::second() - strt_time;
+
+    Real max_err = 0.0;
+    Real max_err_dt = 0.0;
+    for (int m = 0; m < NSCREEN * npts; m++) {
+        max_err = amrex::max(max_err, std::abs(scor_batch[m] - scor[m]) / std::abs(scor[m]));
+        if (scordt[m] != 0.0) {
+            max_err_dt = amrex::max(max_err_dt,
+                                    std::abs(scordt_batch[m] - scordt[m]) / std::abs(scordt[m]));
+        } else {
+            max_err_dt = amrex::max(max_err_dt, std::abs(scordt_batch[m]));
+        }
+    }
+
+    amrex::Print() << "    screen5 per factor = " << pair_time << std::endl;
+    amrex::Print() << "    screen5_batch      = " << batch_time << std::endl;
+    amrex::Print() << "    speedup            = " << pair_time / batch_time << std::endl;
+    amrex::Print() << "    max rel. difference in scor   = " << max_err << std::endl;
+    amrex::Print() << "    max rel. difference in scordt = " << max_err_dt << std::endl;
+}
+
+// Evaluate all NSCREEN screening factors over the zones of state with
+// screen5 and with screen5_batch, separately for the zones where every
+// factor is in the weak screening regime and for those where some
+// factor is in the intermediate or strong regime, since screen5 does
+// much less work in the former.
+void screen_benchmark(const MultiFab& state, const plot_t& vars, const int nrep)
+{
+    Vector<plasma_state_t> pstate_weak;
+    Vector<plasma_state_t> pstate_strong;
+
+    for ( MFIter mfi(state); mfi.isValid(); ++mfi )
+    {
+        const Box& bx = mfi.validbox();
+        auto const sp = state.const_array(mfi);
+
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+        {
+            Real ymass[NumSpec];
+            for (int n = 0; n < NumSpec; n++) {
+                ymass[n] = sp(i, j, k, vars.ispec+n) / aion[n];
+            }
+
+            plasma_state_t ps;
+            fill_plasma_state(ps, sp(i, j, k, vars.itemp), sp(i, j, k, vars.irho), ymass);
+
+            if (weak_screening_zone(ps)) {
+                pstate_weak.push_back(ps);
+            } else {
+                pstate_strong.push_back(ps);
+            }
+        });
+    }
+
+    amrex::Print() << "batched screening benchmark: "
+                   << pstate_weak.size() + pstate_strong.size() << " zones x "
+                   << nrep << " repetitions, " << NSCREEN << " screening factors" << std::endl;
+
+    screen_benchmark_zones(pstate_weak, nrep, "weak");
+    screen_benchmark_zones(pstate_strong, nrep, "intermediate/strong");
+}
 
 int main (int argc, char* argv[])
 {
@@ -37,6 +158,8 @@ void main_main ()
 
     // AMREX_SPACEDIM: number of dimensions
     int n_cell, max_grid_size;
+    int do_screen_benchmark = 0;
+    int screen_benchmark_nrep = 10;
     Vector<int> bc_lo(AMREX_SPACEDIM,0);
     Vector<int> bc_hi(AMREX_SPACEDIM,0);
 
@@ -53,6 +176,11 @@ void main_main ()
         max_grid_size = 32;
         pp.query("max_grid_size", max_grid_size);
 
+        // Optionally time the batched screening against screen5 and
+        // check that they agree
+        pp.query("do_screen_benchmark", do_screen_benchmark);
+        pp.query("screen_benchmark_nrep", screen_benchmark_nrep);
+
     }
 
     Vector<int> is_periodic(AMREX_SPACEDIM,0);
@@ -713,4 +841,8 @@ void main_main ()
     // Tell the I/O Processor to write out the "run time"
     amrex::Print() << "Run time = " << stop_time << std::endl;
 
+    if (do_screen_benchmark) {
+        screen_benchmark(state, vars, screen_benchmark_nrep);
+    }
+
 }
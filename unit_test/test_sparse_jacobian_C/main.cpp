@@ -0,0 +1,210 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Box.H>
+#include <AMReX_Loop.H>
+
+using namespace amrex;
+
+#include "test_sparse_jacobian.H"
+#include "test_sparse_jacobian_F.H"
+#include "AMReX_buildInfo.H"
+
+#include <network.H>
+#include <eos.H>
+
+#include <cmath>
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+
+    main_main();
+
+    amrex::Finalize();
+    return 0;
+}
+
+// the normwise backward error of the solution x of a x = b, in the
+// max norm
+Real backward_error (const Real* a, const Real* b, const Real* x, const int neqs)
+{
+    Real r_norm = 0.0_rt;
+    Real a_norm = 0.0_rt;
+    Real x_norm = 0.0_rt;
+    Real b_norm = 0.0_rt;
+
+    for (int m = 0; m < neqs; m++) {
+        // a is in Fortran order
+        Real r = -b[m];
+        Real a_row = 0.0_rt;
+        for (int n = 0; n < neqs; n++) {
+            r += a[n*neqs + m] * x[n];
+            a_row += std::abs(a[n*neqs + m]);
+        }
+        r_norm = amrex::max(r_norm, std::abs(r));
+        a_norm = amrex::max(a_norm, a_row);
+        x_norm = amrex::max(x_norm, std::abs(x[m]));
+        b_norm = amrex::max(b_norm, std::abs(b[m]));
+    }
+
+    return r_norm / (a_norm * x_norm + b_norm);
+}
+
+void main_main ()
+{
+
+    int n_cell;
+
+    // inputs parameters
+    {
+        // ParmParse is way of reading inputs from the inputs file
+        ParmParse pp;
+
+        // n_cell is the number of points in density, temperature,
+        // and composition
+        pp.get("n_cell", n_cell);
+    }
+
+    // do the runtime parameter initializations and microphysics inits
+    if (ParallelDescriptor::IOProcessor()) {
+        std::cout << "reading extern runtime parameters ..." << std::endl;
+    }
+
+    ParmParse ppa("amr");
+
+    std::string probin_file = "probin";
+
+    ppa.query("probin_file", probin_file);
+
+    const int probin_file_length = probin_file.length();
+    Vector<int> probin_file_name(probin_file_length);
+
+    for (int i = 0; i < probin_file_length; i++)
+        probin_file_name[i] = probin_file[i];
+
+    init_unit_test(probin_file_name.dataPtr(), &probin_file_length);
+
+    init_extern_parameters();
+
+    eos_init();
+
+    Real dlogrho = 0.0e0_rt;
+    Real dlogT   = 0.0e0_rt;
+    Real dfrac   = 0.0e0_rt;
+
+    if (n_cell > 1) {
+        dlogrho = (std::log10(dens_max) - std::log10(dens_min))/(n_cell - 1);
+        dlogT   = (std::log10(temp_max) - std::log10(temp_min))/(n_cell - 1);
+        dfrac   = 1.0_rt / (n_cell - 1);
+    }
+
+    // species, temperature, and energy
+    constexpr int neqs = NumSpec + 2;
+
+    Real max_err_species = 0.0_rt;
+    Real max_err_temp = 0.0_rt;
+    Real max_err_energy = 0.0_rt;
+
+    Real max_diff = 0.0_rt;
+    Real max_berr_linpack = 0.0_rt;
+    Real max_berr_sparse = 0.0_rt;
+
+    Real time_linpack = 0.0_rt;
+    Real time_sparse = 0.0_rt;
+
+    Box bx(IntVect(AMREX_D_DECL(0, 0, 0)),
+           IntVect(AMREX_D_DECL(n_cell-1, n_cell-1, n_cell-1)));
+
+    amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+    {
+        // the composition goes from pure first species to an even mix
+        // of all of the species
+        Real frac = static_cast<Real>(k) * dfrac;
+
+        Real xn[NumSpec];
+        for (int n = 0; n < NumSpec; n++) {
+            xn[n] = frac / NumSpec;
+        }
+        xn[0] += 1.0_rt - frac;
+
+        Real temp = std::pow(10.0_rt, std::log10(temp_min) + static_cast<Real>(j)*dlogT);
+        Real dens = std::pow(10.0_rt, std::log10(dens_min) + static_cast<Real>(i)*dlogrho);
+
+        // the colored numerical Jacobian
+
+        Real err_species, err_temp, err_energy;
+
+        compare_colored_jac_F(temp, dens, xn, &err_species, &err_temp, &err_energy);
+
+        max_err_species = amrex::max(max_err_species, err_species);
+        max_err_temp = amrex::max(max_err_temp, err_temp);
+        max_err_energy = amrex::max(max_err_energy, err_energy);
+
+        // the sparse LU
+
+        Real a_sparse[neqs * neqs];
+        Real a_dense[neqs * neqs];
+        Real b[neqs];
+
+        setup_linear_system_F(temp, dens, xn, dt_lu, a_sparse, a_dense, b);
+
+        Real x_linpack[neqs];
+        Real x_sparse[neqs];
+
+        Real t0 = ParallelDescriptor::second();
+
+        linpack_solve_F(a_dense, b, x_linpack, n_repeat);
+
+        Real t1 = ParallelDescriptor::second();
+
+        sparse_lu_solve_F(a_sparse, b, x_sparse, n_repeat);
+
+        Real t2 = ParallelDescriptor::second();
+
+        time_linpack += t1 - t0;
+        time_sparse += t2 - t1;
+
+        max_berr_linpack = amrex::max(max_berr_linpack,
+                                      backward_error(a_dense, b, x_linpack, neqs));
+        max_berr_sparse = amrex::max(max_berr_sparse,
+                                     backward_error(a_dense, b, x_sparse, neqs));
+
+        Real x_norm = 0.0_rt;
+        Real diff_norm = 0.0_rt;
+        for (int n = 0; n < neqs; n++) {
+            x_norm = amrex::max(x_norm, std::abs(x_linpack[n]));
+            diff_norm = amrex::max(diff_norm, std::abs(x_linpack[n] - x_sparse[n]));
+        }
+
+        if (x_norm > 0.0_rt) {
+            max_diff = amrex::max(max_diff, diff_norm / x_norm);
+        }
+    });
+
+    const Real n_solves = static_cast<Real>(bx.numPts()) * n_repeat;
+
+    amrex::Print() << "number of zones = " << bx.numPts() << std::endl;
+    amrex::Print() << "number of equations = " << neqs << std::endl;
+    amrex::Print() << std::endl;
+    amrex::Print() << "colored vs. uncolored numerical Jacobian:" << std::endl;
+    amrex::Print() << "  max relative difference in the species rows       = " << max_err_species << std::endl;
+    amrex::Print() << "  max relative difference in the temperature column = " << max_err_temp << std::endl;
+    amrex::Print() << "  max relative difference in the energy row         = " << max_err_energy << std::endl;
+    amrex::Print() << std::endl;
+    amrex::Print() << "sparse LU vs. LINPACK:" << std::endl;
+    amrex::Print() << "  max backward error, LINPACK   = " << max_berr_linpack << std::endl;
+    amrex::Print() << "  max backward error, sparse LU = " << max_berr_sparse << std::endl;
+    amrex::Print() << "  max relative difference in the solution = " << max_diff << std::endl;
+    amrex::Print() << "  LINPACK time per factor + solve   = " << time_linpack / n_solves << std::endl;
+    amrex::Print() << "  sparse LU time per factor + solve = " << time_sparse / n_solves << std::endl;
+    amrex::Print() << "  speedup = " << time_linpack / time_sparse << std::endl;
+
+    if (max_err_species > jac_tol || max_err_temp > jac_tol || max_err_energy > jac_tol) {
+        amrex::Error("colored and uncolored numerical Jacobians differ by more than jac_tol");
+    }
+
+    if (max_berr_sparse > lu_tol) {
+        amrex::Error("sparse LU backward error exceeds lu_tol");
+    }
+
+}
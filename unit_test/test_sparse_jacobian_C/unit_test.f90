@@ -0,0 +1,288 @@
+subroutine init_unit_test(name, namlen) bind(C, name="init_unit_test")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use extern_probin_module
+  use microphysics_module
+  use integrator_module, only: integrator_init
+
+  implicit none
+
+  integer, intent(in) :: namlen
+  integer, intent(in) :: name(namlen)
+
+  call runtime_init(name, namlen)
+
+  call microphysics_init(small_temp, small_dens)
+
+  ! this builds the CSR location map, the Jacobian coloring, and the
+  ! sparse LU ordering and symbolic factorization
+  call integrator_init()
+
+end subroutine init_unit_test
+
+
+
+! Fill a burn_t from the EOS at the given thermodynamic state.
+
+subroutine setup_burn_state(temp, dens, xn, state)
+
+  use amrex_fort_module, only: rt => amrex_real
+  use network, only: nspec
+  use burn_type_module, only: burn_t, eos_to_burn
+  use eos_type_module, only: eos_t, eos_input_rt
+  use eos_module, only: eos
+
+  implicit none
+
+  real(rt), intent(in) :: temp, dens
+  real(rt), intent(in) :: xn(nspec)
+  type (burn_t), intent(inout) :: state
+
+  type (eos_t) :: eos_state
+
+  eos_state % rho = dens
+  eos_state % T = temp
+  eos_state % xn(:) = xn(:)
+
+  call eos(eos_input_rt, eos_state)
+
+  call eos_to_burn(eos_state, state)
+
+  state % self_heat = .true.
+
+end subroutine setup_burn_state
+
+
+
+! Evaluate the numerical Jacobian at the given thermodynamic state
+! both with and without the coloring, and return the largest
+! difference between them, relative to the largest entry of its row,
+! over the species rows (err_species), and relative to the entry, over
+! the temperature column of the energy and temperature rows (err_temp)
+! -- the entries the colored Jacobian gets by differencing.
+!
+! The colored Jacobian takes the species columns of the energy row
+! from the network's analytic Jacobian, so err_energy compares them to
+! it, relative to the largest of them.  These include the thermal
+! neutrino losses, but not the composition dependence of the
+! screening, which the uncolored Jacobian picks up by differencing.
+
+subroutine compare_colored_jac_F(temp, dens, xn, err_species, err_temp, err_energy) &
+     bind(C, name="compare_colored_jac_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_constants_module, only: ZERO
+  use network, only: nspec, aion_inv
+  use burn_type_module, only: burn_t, neqs, net_ienuc, net_itemp
+  use actual_network, only: csr_jac_row_count
+  use actual_rhs_module, only: actual_jac
+  use jacobian_sparsity_module, only: get_jac_entry
+  use numerical_jac_module, only: numerical_jac
+  use extern_probin_module, only: colored_numerical_jac
+
+  implicit none
+
+  real(rt), intent(in), value :: temp, dens
+  real(rt), intent(in) :: xn(nspec)
+  real(rt), intent(inout) :: err_species, err_temp, err_energy
+
+  type (burn_t) :: state
+  real(rt) :: jac(neqs * neqs), jac_colored(neqs * neqs), jac_analytic(neqs * neqs)
+  real(rt) :: row_max, val, val_colored
+  real(rt) :: energy_row(nspec)
+  logical :: colored_save
+  integer :: m, n, loc
+
+  call setup_burn_state(temp, dens, xn, state)
+
+  ! the Jacobians are in CSR form, in the first NETWORK_SPARSE_JAC_NNZ
+  ! elements of the integrators' neqs x neqs storage
+
+  colored_save = colored_numerical_jac
+
+  colored_numerical_jac = .false.
+  call numerical_jac(state, jac)
+
+  colored_numerical_jac = .true.
+  call numerical_jac(state, jac_colored)
+
+  colored_numerical_jac = colored_save
+
+  err_species = ZERO
+
+  do m = 1, nspec
+     row_max = maxval(abs(jac(csr_jac_row_count(m):csr_jac_row_count(m+1)-1)))
+     if (row_max == ZERO) cycle
+     do loc = csr_jac_row_count(m), csr_jac_row_count(m+1) - 1
+        err_species = max(err_species, abs(jac_colored(loc) - jac(loc)) / row_max)
+     enddo
+  enddo
+
+  err_temp = ZERO
+
+  do m = net_itemp, net_ienuc
+     call get_jac_entry(jac, m, net_itemp, val)
+     call get_jac_entry(jac_colored, m, net_itemp, val_colored)
+     if (val /= ZERO) then
+        err_temp = max(err_temp, abs(val_colored - val) / abs(val))
+     endif
+  enddo
+
+  ! the analytic Jacobian is in terms of Y, so scale its species
+  ! columns to get derivatives with respect to X
+
+  call actual_jac(state, jac_analytic)
+
+  do n = 1, nspec
+     call get_jac_entry(jac_analytic, net_ienuc, n, energy_row(n))
+     energy_row(n) = energy_row(n) * aion_inv(n)
+  enddo
+
+  err_energy = ZERO
+
+  row_max = maxval(abs(energy_row))
+
+  if (row_max > ZERO) then
+     do n = 1, nspec
+        call get_jac_entry(jac_colored, net_ienuc, n, val_colored)
+        err_energy = max(err_energy, abs(val_colored - energy_row(n)) / row_max)
+     enddo
+  endif
+
+end subroutine compare_colored_jac_F
+
+
+
+! Build the matrix I - dt J that VODE factors, from the network's
+! analytic (CSR) Jacobian at the given thermodynamic state, with the
+! species in terms of mass fractions, as in vode_rhs.F90: a_sparse in
+! the layout of the sparse LU factors and a_dense as a dense matrix.
+! The right hand side b is all ones.
+
+subroutine setup_linear_system_F(temp, dens, xn, dt, a_sparse, a_dense, b) &
+     bind(C, name="setup_linear_system_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_constants_module, only: ONE
+  use network, only: nspec, aion, aion_inv
+  use burn_type_module, only: burn_t, neqs
+  use actual_rhs_module, only: actual_jac
+  use jacobian_sparsity_module, only: get_jac_entry
+  use sparse_lu_module, only: csr_to_sparse_lu, sparse_lu_scale_rows_cols, sparse_lu_scale_shift
+
+  implicit none
+
+  real(rt), intent(in), value :: temp, dens, dt
+  real(rt), intent(in) :: xn(nspec)
+  real(rt), intent(inout) :: a_sparse(neqs * neqs)
+  real(rt), intent(inout) :: a_dense(neqs, neqs)
+  real(rt), intent(inout) :: b(neqs)
+
+  type (burn_t) :: state
+  real(rt) :: row_scale(neqs), col_scale(neqs)
+  integer :: m, n
+
+  call setup_burn_state(temp, dens, xn, state)
+
+  ! the network gives the CSR Jacobian in the first
+  ! NETWORK_SPARSE_JAC_NNZ elements of a_sparse
+  call actual_jac(state, a_sparse)
+
+  do m = 1, neqs
+     do n = 1, neqs
+        call get_jac_entry(a_sparse, m, n, a_dense(m,n))
+     enddo
+  enddo
+
+  row_scale(:) = ONE
+  col_scale(:) = ONE
+  row_scale(1:nspec) = aion(1:nspec)
+  col_scale(1:nspec) = aion_inv(1:nspec)
+
+  call csr_to_sparse_lu(a_sparse)
+  call sparse_lu_scale_rows_cols(a_sparse, row_scale, col_scale)
+  call sparse_lu_scale_shift(a_sparse, -dt, ONE)
+
+  do n = 1, neqs
+     a_dense(:,n) = -dt * row_scale(:) * a_dense(:,n) * col_scale(n)
+     a_dense(n,n) = ONE + a_dense(n,n)
+  enddo
+
+  b(:) = ONE
+
+end subroutine setup_linear_system_F
+
+
+
+! Factor a and solve a x = b nrep times with the LINPACK routines
+! used by VODE.
+
+subroutine linpack_solve_F(a, b, x, nrep) bind(C, name="linpack_solve_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_error_module, only: amrex_error
+  use burn_type_module, only: neqs
+  use linpack_module, only: dgefa, dgesl
+
+  implicit none
+
+  real(rt), intent(in) :: a(neqs, neqs)
+  real(rt), intent(in) :: b(neqs)
+  real(rt), intent(inout) :: x(neqs)
+  integer, intent(in), value :: nrep
+
+  real(rt) :: lu(neqs, neqs)
+  integer :: ipvt(neqs)
+  integer :: info, n
+
+  do n = 1, nrep
+     lu(:,:) = a(:,:)
+     x(:) = b(:)
+
+     call dgefa(lu, ipvt, info)
+
+     if (info /= 0) then
+        call amrex_error("dgefa found a singular matrix")
+     endif
+
+     call dgesl(lu, ipvt, x)
+  enddo
+
+end subroutine linpack_solve_F
+
+
+
+! Factor a (in the layout of the sparse LU factors) and solve a x = b
+! nrep times with the sparse LU.
+
+subroutine sparse_lu_solve_F(a, b, x, nrep) bind(C, name="sparse_lu_solve_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_error_module, only: amrex_error
+  use burn_type_module, only: neqs
+  use sparse_lu_module, only: sparse_lu_copy, sparse_lu_factor, sparse_lu_solve
+
+  implicit none
+
+  real(rt), intent(in) :: a(neqs * neqs)
+  real(rt), intent(in) :: b(neqs)
+  real(rt), intent(inout) :: x(neqs)
+  integer, intent(in), value :: nrep
+
+  real(rt) :: lu(neqs * neqs)
+  integer :: info, n
+
+  do n = 1, nrep
+     call sparse_lu_copy(a, lu)
+     x(:) = b(:)
+
+     call sparse_lu_factor(lu, info)
+
+     if (info /= 0) then
+        call amrex_error("sparse_lu_factor found a zero pivot")
+     endif
+
+     call sparse_lu_solve(lu, x)
+  enddo
+
+end subroutine sparse_lu_solve_F
@@ -0,0 +1,208 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Box.H>
+#include <AMReX_Loop.H>
+
+using namespace amrex;
+
+#include "test_unrolled_lu.H"
+#include "test_unrolled_lu_F.H"
+#include "AMReX_buildInfo.H"
+
+#include <network.H>
+#include <eos.H>
+
+#include <cmath>
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+
+    main_main();
+
+    amrex::Finalize();
+    return 0;
+}
+
+void main_main ()
+{
+
+    int n_cell;
+
+    // inputs parameters
+    {
+        // ParmParse is way of reading inputs from the inputs file
+        ParmParse pp;
+
+        // n_cell is the number of points in density, temperature,
+        // and composition
+        pp.get("n_cell", n_cell);
+    }
+
+    // do the runtime parameter initializations and microphysics inits
+    if (ParallelDescriptor::IOProcessor()) {
+        std::cout << "reading extern runtime parameters ..." << std::endl;
+    }
+
+    ParmParse ppa("amr");
+
+    std::string probin_file = "probin";
+
+    ppa.query("probin_file", probin_file);
+
+    const int probin_file_length = probin_file.length();
+    Vector<int> probin_file_name(probin_file_length);
+
+    for (int i = 0; i < probin_file_length; i++)
+        probin_file_name[i] = probin_file[i];
+
+    init_unit_test(probin_file_name.dataPtr(), &probin_file_length);
+
+    init_extern_parameters();
+
+    eos_init();
+
+    Real dlogrho = 0.0e0_rt;
+    Real dlogT   = 0.0e0_rt;
+    Real dfrac   = 0.0e0_rt;
+
+    if (n_cell > 1) {
+        dlogrho = (std::log10(dens_max) - std::log10(dens_min))/(n_cell - 1);
+        dlogT   = (std::log10(temp_max) - std::log10(temp_min))/(n_cell - 1);
+        dfrac   = 1.0_rt / (n_cell - 1);
+    }
+
+    // species, temperature, and energy
+    constexpr int neqs = NumSpec + 2;
+
+    Real max_diff = 0.0_rt;
+
+    Real time_linpack = 0.0_rt;
+    Real time_unrolled = 0.0_rt;
+
+    Real time_linpack_solve = 0.0_rt;
+    Real time_unrolled_solve = 0.0_rt;
+
+    Real time_burn = 0.0_rt;
+    long n_rhs_total = 0;
+    long n_jac_total = 0;
+    int n_failed = 0;
+
+    Box bx(IntVect(AMREX_D_DECL(0, 0, 0)),
+           IntVect(AMREX_D_DECL(n_cell-1, n_cell-1, n_cell-1)));
+
+    amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+    {
+        // the composition goes from pure first species to an even mix
+        // of all of the species
+        Real frac = static_cast<Real>(k) * dfrac;
+
+        Real xn[NumSpec];
+        for (int n = 0; n < NumSpec; n++) {
+            xn[n] = frac / NumSpec;
+        }
+        xn[0] += 1.0_rt - frac;
+
+        Real temp = std::pow(10.0_rt, std::log10(temp_min) + static_cast<Real>(j)*dlogT);
+        Real dens = std::pow(10.0_rt, std::log10(dens_min) + static_cast<Real>(i)*dlogrho);
+
+        Real a[neqs * neqs];
+        Real b[neqs];
+
+        setup_linear_system_F(temp, dens, xn, dt_lu, a, b);
+
+        Real x_linpack[neqs];
+        Real x_unrolled[neqs];
+
+        Real t0 = ParallelDescriptor::second();
+
+        linpack_solve_F(a, b, x_linpack, n_repeat);
+
+        Real t1 = ParallelDescriptor::second();
+
+        unrolled_lu_solve_F(a, b, x_unrolled, n_repeat);
+
+        Real t2 = ParallelDescriptor::second();
+
+        linpack_resolve_F(a, b, x_linpack, n_repeat);
+
+        Real t3 = ParallelDescriptor::second();
+
+        unrolled_lu_resolve_F(a, b, x_unrolled, n_repeat);
+
+        Real t4 = ParallelDescriptor::second();
+
+        time_linpack += t1 - t0;
+        time_unrolled += t2 - t1;
+
+        time_linpack_solve += t3 - t2;
+        time_unrolled_solve += t4 - t3;
+
+        // a burn of this zone, to count the factorizations and
+        // solves it does
+
+        int n_rhs, n_jac, success;
+
+        Real t5 = ParallelDescriptor::second();
+
+        burn_zone_F(temp, dens, xn, tmax, &n_rhs, &n_jac, &success);
+
+        time_burn += ParallelDescriptor::second() - t5;
+
+        n_rhs_total += n_rhs;
+        n_jac_total += n_jac;
+
+        if (!success) {
+            n_failed++;
+        }
+
+        Real x_norm = 0.0_rt;
+        Real diff_norm = 0.0_rt;
+        for (int n = 0; n < neqs; n++) {
+            x_norm = amrex::max(x_norm, std::abs(x_linpack[n]));
+            diff_norm = amrex::max(diff_norm, std::abs(x_linpack[n] - x_unrolled[n]));
+        }
+
+        if (x_norm > 0.0_rt) {
+            max_diff = amrex::max(max_diff, diff_norm / x_norm);
+        }
+    });
+
+    const Real n_solves = static_cast<Real>(bx.numPts()) * n_repeat;
+
+    amrex::Print() << "number of zones = " << bx.numPts() << std::endl;
+    amrex::Print() << "number of equations = " << neqs << std::endl;
+    amrex::Print() << "max relative difference in the solution = " << max_diff << std::endl;
+    amrex::Print() << "LINPACK time per factor + solve     = " << time_linpack / n_solves << std::endl;
+    amrex::Print() << "unrolled LU time per factor + solve = " << time_unrolled / n_solves << std::endl;
+    amrex::Print() << "speedup = " << time_linpack / time_unrolled << std::endl;
+    amrex::Print() << "LINPACK time per solve     = " << time_linpack_solve / n_solves << std::endl;
+    amrex::Print() << "unrolled LU time per solve = " << time_unrolled_solve / n_solves << std::endl;
+
+    // Per burn: VODE factors at least once per Jacobian evaluation,
+    // and does one solve per Newton iteration, each of which is one
+    // RHS evaluation, so this estimate counts n_jac factorizations and
+    // n_rhs solves.
+
+    const Real n_burns = static_cast<Real>(bx.numPts());
+
+    const Real dt_factor = ((time_linpack - time_linpack_solve) -
+                            (time_unrolled - time_unrolled_solve)) / n_solves;
+    const Real dt_solve = (time_linpack_solve - time_unrolled_solve) / n_solves;
+
+    const Real dt_burn = (static_cast<Real>(n_jac_total) * dt_factor +
+                          static_cast<Real>(n_rhs_total) * dt_solve) / n_burns;
+
+    amrex::Print() << std::endl;
+    amrex::Print() << "burns of tmax = " << tmax << " (" << n_failed << " failed):" << std::endl;
+    amrex::Print() << "  Jacobian evaluations per burn = " << n_jac_total / n_burns << std::endl;
+    amrex::Print() << "  RHS evaluations per burn      = " << n_rhs_total / n_burns << std::endl;
+    amrex::Print() << "  time per burn, this build     = " << time_burn / n_burns << std::endl;
+    amrex::Print() << "  estimated LU time saved per burn = " << dt_burn
+                   << " (" << 100.0_rt * dt_burn / (time_burn / n_burns) << "% of the burn)" << std::endl;
+
+    if (max_diff > lu_tol) {
+        amrex::Error("unrolled LU and LINPACK solutions differ by more than lu_tol");
+    }
+
+}
@@ -0,0 +1,270 @@
+subroutine init_unit_test(name, namlen) bind(C, name="init_unit_test")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use extern_probin_module
+  use microphysics_module
+
+  implicit none
+
+  integer, intent(in) :: namlen
+  integer, intent(in) :: name(namlen)
+
+  call runtime_init(name, namlen)
+
+  call microphysics_init(small_temp, small_dens)
+
+end subroutine init_unit_test
+
+
+
+! Build the matrix I - dt J that VODE factors, from the network's
+! analytic Jacobian at the given thermodynamic state (with the species
+! in terms of mass fractions, as in vode_rhs.F90), and a right hand
+! side of all ones.
+
+subroutine setup_linear_system_F(temp, dens, xn, dt, a, b) bind(C, name="setup_linear_system_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_constants_module, only: ONE
+  use network, only: nspec, aion, aion_inv
+  use burn_type_module, only: burn_t, neqs, eos_to_burn
+  use eos_type_module, only: eos_t, eos_input_rt
+  use eos_module, only: eos
+  use actual_rhs_module, only: actual_jac
+
+  implicit none
+
+  real(rt), intent(in), value :: temp, dens, dt
+  real(rt), intent(in) :: xn(nspec)
+  real(rt), intent(inout) :: a(neqs, neqs)
+  real(rt), intent(inout) :: b(neqs)
+
+  type (eos_t) :: eos_state
+  type (burn_t) :: state
+  integer :: n
+
+  eos_state % rho = dens
+  eos_state % T = temp
+  eos_state % xn(:) = xn(:)
+
+  call eos(eos_input_rt, eos_state)
+
+  call eos_to_burn(eos_state, state)
+
+  state % self_heat = .true.
+
+  call actual_jac(state, a)
+
+  do n = 1, nspec
+     a(n,:) = a(n,:) * aion(n)
+     a(:,n) = a(:,n) * aion_inv(n)
+  enddo
+
+  a(:,:) = -dt * a(:,:)
+
+  do n = 1, neqs
+     a(n,n) = ONE + a(n,n)
+  enddo
+
+  b(:) = ONE
+
+end subroutine setup_linear_system_F
+
+
+
+! Factor a and solve a x = b nrep times with the LINPACK routines
+! used by VODE.
+
+subroutine linpack_solve_F(a, b, x, nrep) bind(C, name="linpack_solve_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_error_module, only: amrex_error
+  use burn_type_module, only: neqs
+  use linpack_module, only: dgefa, dgesl
+
+  implicit none
+
+  real(rt), intent(in) :: a(neqs, neqs)
+  real(rt), intent(in) :: b(neqs)
+  real(rt), intent(inout) :: x(neqs)
+  integer, intent(in), value :: nrep
+
+  real(rt) :: lu(neqs, neqs)
+  integer :: ipvt(neqs)
+  integer :: info, n
+
+  do n = 1, nrep
+     lu(:,:) = a(:,:)
+     x(:) = b(:)
+
+     call dgefa(lu, ipvt, info)
+
+     if (info /= 0) then
+        call amrex_error("dgefa found a singular matrix")
+     endif
+
+     call dgesl(lu, ipvt, x)
+  enddo
+
+end subroutine linpack_solve_F
+
+
+
+! Factor a and solve a x = b nrep times with the generated unrolled
+! LU for this network.
+
+subroutine unrolled_lu_solve_F(a, b, x, nrep) bind(C, name="unrolled_lu_solve_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_error_module, only: amrex_error
+  use burn_type_module, only: neqs
+  use unrolled_lu_module, only: unrolled_lu_factor, unrolled_lu_solve
+
+  implicit none
+
+  real(rt), intent(in) :: a(neqs, neqs)
+  real(rt), intent(in) :: b(neqs)
+  real(rt), intent(inout) :: x(neqs)
+  integer, intent(in), value :: nrep
+
+  real(rt) :: lu(neqs, neqs)
+  integer :: info, n
+
+  do n = 1, nrep
+     lu(:,:) = a(:,:)
+     x(:) = b(:)
+
+     call unrolled_lu_factor(lu, info)
+
+     if (info /= 0) then
+        call amrex_error("unrolled_lu_factor found a zero pivot")
+     endif
+
+     call unrolled_lu_solve(lu, x)
+  enddo
+
+end subroutine unrolled_lu_solve_F
+
+
+
+! Factor a once and solve a x = b nrep times with the LINPACK routines
+! used by VODE, to time the solve on its own.
+
+subroutine linpack_resolve_F(a, b, x, nrep) bind(C, name="linpack_resolve_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_error_module, only: amrex_error
+  use burn_type_module, only: neqs
+  use linpack_module, only: dgefa, dgesl
+
+  implicit none
+
+  real(rt), intent(in) :: a(neqs, neqs)
+  real(rt), intent(in) :: b(neqs)
+  real(rt), intent(inout) :: x(neqs)
+  integer, intent(in), value :: nrep
+
+  real(rt) :: lu(neqs, neqs)
+  integer :: ipvt(neqs)
+  integer :: info, n
+
+  lu(:,:) = a(:,:)
+
+  call dgefa(lu, ipvt, info)
+
+  if (info /= 0) then
+     call amrex_error("dgefa found a singular matrix")
+  endif
+
+  do n = 1, nrep
+     x(:) = b(:)
+
+     call dgesl(lu, ipvt, x)
+  enddo
+
+end subroutine linpack_resolve_F
+
+
+
+! Factor a once and solve a x = b nrep times with the generated
+! unrolled LU for this network, to time the solve on its own.
+
+subroutine unrolled_lu_resolve_F(a, b, x, nrep) bind(C, name="unrolled_lu_resolve_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_error_module, only: amrex_error
+  use burn_type_module, only: neqs
+  use unrolled_lu_module, only: unrolled_lu_factor, unrolled_lu_solve
+
+  implicit none
+
+  real(rt), intent(in) :: a(neqs, neqs)
+  real(rt), intent(in) :: b(neqs)
+  real(rt), intent(inout) :: x(neqs)
+  integer, intent(in), value :: nrep
+
+  real(rt) :: lu(neqs, neqs)
+  integer :: info, n
+
+  lu(:,:) = a(:,:)
+
+  call unrolled_lu_factor(lu, info)
+
+  if (info /= 0) then
+     call amrex_error("unrolled_lu_factor found a zero pivot")
+  endif
+
+  do n = 1, nrep
+     x(:) = b(:)
+
+     call unrolled_lu_solve(lu, x)
+  enddo
+
+end subroutine unrolled_lu_resolve_F
+
+
+
+! Burn a zone at the given thermodynamic state for a time tmax, and
+! return the number of RHS and Jacobian evaluations it took.
+
+subroutine burn_zone_F(temp, dens, xn, tmax, n_rhs, n_jac, success) bind(C, name="burn_zone_F")
+
+  use amrex_fort_module, only: rt => amrex_real
+  use amrex_constants_module, only: ZERO
+  use network, only: nspec
+  use burn_type_module, only: burn_t, eos_to_burn
+  use eos_type_module, only: eos_t, eos_input_rt
+  use eos_module, only: eos
+  use burner_module, only: burner
+
+  implicit none
+
+  real(rt), intent(in), value :: temp, dens, tmax
+  real(rt), intent(in) :: xn(nspec)
+  integer, intent(inout) :: n_rhs, n_jac, success
+
+  type (eos_t) :: eos_state
+  type (burn_t) :: state_in, state_out
+
+  eos_state % rho = dens
+  eos_state % T = temp
+  eos_state % xn(:) = xn(:)
+
+  call eos(eos_input_rt, eos_state)
+
+  call eos_to_burn(eos_state, state_in)
+
+  state_in % self_heat = .true.
+
+  call burner(state_in, state_out, tmax, ZERO)
+
+  n_rhs = state_out % n_rhs
+  n_jac = state_out % n_jac
+
+  if (state_out % success) then
+     success = 1
+  else
+     success = 0
+  endif
+
+end subroutine burn_zone_F